@@ -0,0 +1,188 @@
+#include "BlurEffects.hpp"
+#include "RenderScheduler.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Rows per parallel tile, like the main render pass
+const int TILE_ROWS = 16;
+// Columns per tile of the vertical prefix pass
+const int TILE_COLUMNS = 64;
+
+// Largest radius in fractions of the longer image side, so the look does
+// not depend on the GIF resolution
+const float MAX_BLUR_RADIUS = 0.05f;
+const float BLOOM_RADIUS = 0.02f;
+const float MAX_BLOOM_RADIUS = 0.06f;
+const float GLOW_RADIUS = 0.03f;
+const float MAX_GLOW_RADIUS = 0.08f;
+// Only channel levels above this feed the bloom
+const int BLOOM_THRESHOLD = 180;
+
+int tileCount(int size, int tile) {
+    return (size + tile - 1) / tile;
+}
+
+} // end anonymous namespace
+
+void BlurEffects::apply(std::vector<unsigned char>& frame, int frameWidth, int frameHeight,
+                        float blur, float bloom, float glow) {
+    if (blur <= 0.0f && bloom <= 0.0f && glow <= 0.0f) return;
+
+    width = frameWidth;
+    height = frameHeight;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    // One spare value: the box kernels load 4 lanes for 3 channels
+    table.resize(static_cast<size_t>(width + 1) * (height + 1) * 3 + 1);
+    blurred.resize(pixelCount * 4);
+    int longSide = std::max(width, height);
+    RenderScheduler& scheduler = RenderScheduler::instance();
+
+    // Blur: replace the frame by its box average
+    if (blur > 0.0f) {
+        int radius = std::max(1, static_cast<int>(blur * MAX_BLUR_RADIUS * longSide));
+        buildTable(frame.data());
+        boxFilter(radius, frame.data());
+    }
+
+    // Glow: screen a soft copy of the whole frame over itself
+    if (glow > 0.0f) {
+        float radiusScale = GLOW_RADIUS + glow * (MAX_GLOW_RADIUS - GLOW_RADIUS);
+        int radius = std::max(1, static_cast<int>(radiusScale * longSide));
+        buildTable(frame.data());
+        boxFilter(radius, blurred.data());
+
+        int amount = static_cast<int>(glow * 256.0f);
+        scheduler.parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+            size_t begin = static_cast<size_t>(tile) * TILE_ROWS * width * 4;
+            size_t end = std::min(pixelCount * 4, begin + static_cast<size_t>(TILE_ROWS) * width * 4);
+            for (size_t i = begin; i < end; i += 4) {
+                for (int c = 0; c < 3; c++) {
+                    int base = frame[i + c];
+                    int soft = blurred[i + c] * amount >> 8;
+                    frame[i + c] = static_cast<unsigned char>(base + ((255 - base) * soft) / 255);
+                }
+            }
+        });
+    }
+
+    // Bloom: blur only the highlights and add them back
+    if (bloom > 0.0f) {
+        bright.resize(pixelCount * 4);
+        scheduler.parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+            size_t begin = static_cast<size_t>(tile) * TILE_ROWS * width * 4;
+            size_t end = std::min(pixelCount * 4, begin + static_cast<size_t>(TILE_ROWS) * width * 4);
+            for (size_t i = begin; i < end; i += 4) {
+                for (int c = 0; c < 3; c++) {
+                    int excess = std::max(0, frame[i + c] - BLOOM_THRESHOLD);
+                    bright[i + c] = static_cast<unsigned char>(excess * 255 / (255 - BLOOM_THRESHOLD));
+                }
+            }
+        });
+
+        float radiusScale = BLOOM_RADIUS + bloom * (MAX_BLOOM_RADIUS - BLOOM_RADIUS);
+        int radius = std::max(1, static_cast<int>(radiusScale * longSide));
+        buildTable(bright.data());
+        boxFilter(radius, blurred.data());
+
+        int amount = static_cast<int>(bloom * 384.0f);
+        scheduler.parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+            size_t begin = static_cast<size_t>(tile) * TILE_ROWS * width * 4;
+            size_t end = std::min(pixelCount * 4, begin + static_cast<size_t>(TILE_ROWS) * width * 4);
+            for (size_t i = begin; i < end; i += 4) {
+                for (int c = 0; c < 3; c++) {
+                    int value = frame[i + c] + (blurred[i + c] * amount >> 8);
+                    frame[i + c] = static_cast<unsigned char>(std::min(value, 255));
+                }
+            }
+        });
+    }
+}
+
+void BlurEffects::buildTable(const unsigned char* rgba) {
+    const size_t stride = static_cast<size_t>(width + 1) * 3;
+    RenderScheduler& scheduler = RenderScheduler::instance();
+
+    std::fill(table.begin(), table.begin() + stride, 0);
+
+    // Prefix sums along each row, rows are independent
+    scheduler.parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+        int endY = std::min(height, (tile + 1) * TILE_ROWS);
+        for (int y = tile * TILE_ROWS; y < endY; y++) {
+            const unsigned char* src = rgba + static_cast<size_t>(y) * width * 4;
+            uint32_t* row = table.data() + (y + 1) * stride;
+            uint32_t r = 0, g = 0, b = 0;
+            row[0] = row[1] = row[2] = 0;
+            for (int x = 0; x < width; x++) {
+                r += src[x * 4];
+                g += src[x * 4 + 1];
+                b += src[x * 4 + 2];
+                row[(x + 1) * 3] = r;
+                row[(x + 1) * 3 + 1] = g;
+                row[(x + 1) * 3 + 2] = b;
+            }
+        }
+    });
+
+    // Then down each column, in strips of columns. Sums may wrap for huge
+    // frames; box sums taken by subtraction are still exact.
+    scheduler.parallelFor(tileCount(width + 1, TILE_COLUMNS), [&](int tile) {
+        size_t begin = static_cast<size_t>(tile) * TILE_COLUMNS * 3;
+        size_t end = std::min(stride, begin + static_cast<size_t>(TILE_COLUMNS) * 3);
+        for (int y = 2; y <= height; y++) {
+            uint32_t* row = table.data() + y * stride;
+            const uint32_t* above = row - stride;
+            for (size_t i = begin; i < end; i++) {
+                row[i] += above[i];
+            }
+        }
+    });
+}
+
+void BlurEffects::boxFilter(int radius, unsigned char* dst) {
+    const size_t stride = static_cast<size_t>(width + 1) * 3;
+
+    // Box widths only depend on x, keep their inverses
+    inverseWidths.resize(width);
+    for (int x = 0; x < width; x++) {
+        inverseWidths[x] = 1.0f / (std::min(width, x + radius + 1) - std::max(0, x - radius));
+    }
+
+    // Boxes that fit in the row all have the same width and go to the
+    // vector kernel; the clipped ones at both ends stay scalar
+    const int innerBegin = std::min(radius, width);
+    const int innerEnd = std::max(innerBegin, width - radius);
+    const SimdKernels& kernels = simdKernels();
+
+    RenderScheduler::instance().parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+        int endY = std::min(height, (tile + 1) * TILE_ROWS);
+        for (int y = tile * TILE_ROWS; y < endY; y++) {
+            int y0 = std::max(0, y - radius);
+            int y1 = std::min(height, y + radius + 1);
+            const uint32_t* top = table.data() + y0 * stride;
+            const uint32_t* bottom = table.data() + y1 * stride;
+            float inverseHeight = 1.0f / (y1 - y0);
+            unsigned char* out = dst + static_cast<size_t>(y) * width * 4;
+
+            auto clippedBoxes = [&](int begin, int end) {
+                for (int x = begin; x < end; x++) {
+                    size_t x0 = static_cast<size_t>(std::max(0, x - radius)) * 3;
+                    size_t x1 = static_cast<size_t>(std::min(width, x + radius + 1)) * 3;
+                    float scale = inverseWidths[x] * inverseHeight;
+                    for (int c = 0; c < 3; c++) {
+                        uint32_t sum = bottom[x1 + c] - bottom[x0 + c] - top[x1 + c] + top[x0 + c];
+                        out[x * 4 + c] = static_cast<unsigned char>(sum * scale + 0.5f);
+                    }
+                }
+            };
+
+            clippedBoxes(0, innerBegin);
+            if (innerEnd > innerBegin) {
+                kernels.boxRow(top, bottom, radius, inverseWidths[innerBegin] * inverseHeight, innerBegin, innerEnd, out);
+            }
+            clippedBoxes(innerEnd, width);
+        }
+    });
+}
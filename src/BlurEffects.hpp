@@ -0,0 +1,29 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <cstdint>
+
+using namespace rack;
+
+// Blur, bloom and glow on RGBA frames. Box sums are read from a summed-area
+// table, so every pixel costs the same whatever the radius, and radius can be
+// swept with CV at full resolution. Work is split into row tiles on the
+// render threads.
+struct BlurEffects {
+    // Amounts in 0..1; an amount of 0 skips the stage
+    void apply(std::vector<unsigned char>& frame, int width, int height,
+               float blur, float bloom, float glow);
+
+private:
+    // Running RGB sums with a zero first row and column, (width + 1) x (height + 1)
+    std::vector<uint32_t> table;
+    std::vector<unsigned char> blurred;
+    std::vector<unsigned char> bright;
+    std::vector<float> inverseWidths;
+    int width{0};
+    int height{0};
+
+    void buildTable(const unsigned char* rgba);
+    // Box average of radius around each pixel of the image the table was built from
+    void boxFilter(int radius, unsigned char* dst);
+};
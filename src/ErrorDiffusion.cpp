@@ -0,0 +1,131 @@
+#include "ErrorDiffusion.hpp"
+#include "RenderScheduler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Pixels a row handles between two progress updates
+const int CHUNK = 64;
+// Pixel x of a row needs the row above done up to x + 2; one more column
+// keeps the two rows from adding into the same cell of the row below both
+const int LAG = 3;
+
+struct Tap {
+    int dx;
+    int dy;
+    int weight;
+};
+
+template <int Mode>
+struct Kernel;
+
+template <>
+struct Kernel<ErrorDiffusion::FLOYD_STEINBERG> {
+    static constexpr int DIVISOR = 16;
+    static constexpr Tap TAPS[] = {{1, 0, 7}, {-1, 1, 3}, {0, 1, 5}, {1, 1, 1}};
+};
+
+// Spreads only 6/8 of the error, which keeps highlights and shadows clean
+template <>
+struct Kernel<ErrorDiffusion::ATKINSON> {
+    static constexpr int DIVISOR = 8;
+    static constexpr Tap TAPS[] = {{1, 0, 1}, {2, 0, 1}, {-1, 1, 1}, {0, 1, 1}, {1, 1, 1}, {0, 2, 1}};
+};
+
+template <>
+struct Kernel<ErrorDiffusion::SIERRA> {
+    static constexpr int DIVISOR = 32;
+    static constexpr Tap TAPS[] = {
+        {1, 0, 5}, {2, 0, 3},
+        {-2, 1, 2}, {-1, 1, 4}, {0, 1, 5}, {1, 1, 4}, {2, 1, 2},
+        {-1, 2, 2}, {0, 2, 3}, {1, 2, 2}
+    };
+};
+
+} // end anonymous namespace
+
+void ErrorDiffusion::apply(std::vector<unsigned char>& frame, int frameWidth, int frameHeight, int mode, int levels) {
+    if (mode <= OFF || mode >= NUM_MODES) return;
+    // Every thread in parallelFor holds at most one row, so the rows in
+    // flight are consecutive and no more than the render threads plus the
+    // caller. A row clears the ring row two below it, which must be done.
+    static_assert(RING_ROWS - 2 > static_cast<int>(RenderScheduler::MAX_THREADS) + 1,
+                  "a ring row could be reused while a thread still reads it");
+
+    width = frameWidth;
+    height = frameHeight;
+    errorRows.assign(static_cast<size_t>(RING_ROWS) * (width + 4) * 3, 0);
+    if (progressRows < height) {
+        progress.reset(new std::atomic<int>[height]);
+        progressRows = height;
+    }
+    for (int y = 0; y < height; y++) {
+        progress[y].store(0, std::memory_order_relaxed);
+    }
+
+    // Nearest of the evenly spaced levels
+    levels = std::max(levels, 2);
+    for (int value = 0; value < 256; value++) {
+        int level = (value * (levels - 1) + 127) / 255;
+        quantized[value] = static_cast<unsigned char>(level * 255 / (levels - 1));
+    }
+
+    unsigned char* pixels = frame.data();
+    // Rows are handed out in order, so the row above is always already taken
+    RenderScheduler::instance().parallelFor(height, [&](int y) {
+        switch (mode) {
+            case FLOYD_STEINBERG: diffuseRow<FLOYD_STEINBERG>(pixels, y); break;
+            case ATKINSON: diffuseRow<ATKINSON>(pixels, y); break;
+            default: diffuseRow<SIERRA>(pixels, y); break;
+        }
+    });
+}
+
+template <int Mode>
+void ErrorDiffusion::diffuseRow(unsigned char* frame, int y) {
+    using K = Kernel<Mode>;
+    int16_t* current = errorRow(y) + 6;
+    int16_t* below = errorRow(y + 1) + 6;
+    int16_t* twoBelow = errorRow(y + 2) + 6;
+    // Nobody else writes two rows down yet: start it clean. The row above
+    // only starts adding to it after this row's first progress update.
+    std::fill(twoBelow - 6, twoBelow - 6 + (width + 4) * 3, 0);
+
+    // Error for the next two pixels of this row stays here, not in the ring
+    int ahead[2][3] = {};
+    unsigned char* row = frame + static_cast<size_t>(y) * width * 4;
+
+    for (int start = 0; start < width; start += CHUNK) {
+        int end = std::min(width, start + CHUNK);
+        if (y > 0) {
+            int needed = std::min(width, end + LAG);
+            while (progress[y - 1].load(std::memory_order_acquire) < needed) {
+                std::this_thread::yield();
+            }
+        }
+
+        for (int x = start; x < end; x++) {
+            for (int c = 0; c < 3; c++) {
+                int value = rack::math::clamp(row[x * 4 + c] + current[x * 3 + c] + ahead[0][c], 0, 255);
+                unsigned char result = quantized[value];
+                int error = value - result;
+                row[x * 4 + c] = result;
+
+                ahead[0][c] = ahead[1][c];
+                ahead[1][c] = 0;
+                for (const Tap& tap : K::TAPS) {
+                    int share = error * tap.weight / K::DIVISOR;
+                    if (tap.dy == 0) {
+                        ahead[tap.dx - 1][c] += share;
+                    } else {
+                        int16_t* target = tap.dy == 1 ? below : twoBelow;
+                        target[(x + tap.dx) * 3 + c] += share;
+                    }
+                }
+            }
+        }
+        progress[y].store(end, std::memory_order_release);
+    }
+}
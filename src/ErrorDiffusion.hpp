@@ -0,0 +1,46 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+using namespace rack;
+
+// Error-diffusion dithering to a few levels per channel. Diffusion is
+// serial along a row and from each row into the next ones, so rows run as
+// a wavefront: several render threads each take a row, and every row stays
+// a few pixels behind the one above it.
+struct ErrorDiffusion {
+    enum Mode {
+        OFF,
+        FLOYD_STEINBERG,
+        ATKINSON,
+        SIERRA,
+        NUM_MODES
+    };
+
+    // levels is the number of values kept per channel, at least 2
+    void apply(std::vector<unsigned char>& frame, int width, int height, int mode, int levels);
+
+private:
+    // Error rows in flight; a row is reused once every thread has moved on
+    static constexpr int RING_ROWS = 8;
+
+    // Pending error per channel for the next rows, RING_ROWS rows of
+    // (width + 4) * 3 values with two columns of padding on each side
+    std::vector<int16_t> errorRows;
+    // Columns finished per row, for the rows below to wait on
+    std::unique_ptr<std::atomic<int>[]> progress;
+    int progressRows{0};
+    unsigned char quantized[256];
+    int width{0};
+    int height{0};
+
+    int16_t* errorRow(int y) {
+        return errorRows.data() + static_cast<size_t>(y % RING_ROWS) * (width + 4) * 3;
+    }
+
+    template <int Mode>
+    void diffuseRow(unsigned char* frame, int y);
+};
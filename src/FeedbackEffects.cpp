@@ -0,0 +1,100 @@
+#include "FeedbackEffects.hpp"
+#include "RenderScheduler.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Rows per parallel tile, like the main render pass
+const int TILE_ROWS = 16;
+// At full feedback the new frame still shows through a little, otherwise
+// the picture would freeze
+const int MAX_FEEDBACK_WEIGHT = 248;
+// Per frame, at full zoom: scale change and scroll in fractions of the height
+const float MAX_ZOOM = 0.08f;
+const float MAX_DRIFT = 0.02f;
+
+int tileCount(int size, int tile) {
+    return (size + tile - 1) / tile;
+}
+
+} // end anonymous namespace
+
+void FeedbackEffects::allocate(int frameWidth, int frameHeight) {
+    if (frameWidth == width && frameHeight == height && !storage.empty()) return;
+
+    width = frameWidth;
+    height = frameHeight;
+    size_t frameBytes = static_cast<size_t>(width) * height * 4;
+    storage.assign(frameBytes * history.size(), 0);
+    for (size_t i = 0; i < history.size(); i++) {
+        history[i] = storage.data() + i * frameBytes;
+    }
+    sourceColumns.resize(width);
+    // One scratch row per tile, tiles run in parallel
+    warpedRows.resize(static_cast<size_t>(tileCount(height, TILE_ROWS)) * width * 4);
+    filled = 0;
+}
+
+void FeedbackEffects::apply(std::vector<unsigned char>& frame, int frameWidth, int frameHeight,
+                            float feedback, float zoom, float drift, int delay) {
+    if (feedback <= 0.0f) {
+        // Start from a clean history the next time feedback is turned up
+        filled = 0;
+        return;
+    }
+
+    allocate(frameWidth, frameHeight);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    unsigned char* record = history[HISTORY_FRAMES];
+
+    if (filled == 0) {
+        // Nothing to mix with yet, only remember this frame
+        std::memcpy(record, frame.data(), rowBytes * height);
+    } else {
+        const unsigned char* past = history[std::min(std::max(delay, 1), filled) - 1];
+        int weight = static_cast<int>(feedback * MAX_FEEDBACK_WEIGHT);
+
+        // Nearest sample of the zoomed and scrolled past frame; the edges
+        // repeat where zooming out uncovers them
+        float scale = 1.0f + zoom * MAX_ZOOM;
+        float centerX = (width - 1) * 0.5f;
+        float centerY = (height - 1) * 0.5f;
+        float shift = drift * MAX_DRIFT * height;
+        bool warped = zoom != 0.0f || drift != 0.0f;
+        if (warped) {
+            for (int x = 0; x < width; x++) {
+                int sourceX = static_cast<int>(std::floor(centerX + (x - centerX) / scale + 0.5f));
+                sourceColumns[x] = rack::math::clamp(sourceX, 0, width - 1);
+            }
+        }
+
+        const SimdKernels& kernels = simdKernels();
+        RenderScheduler::instance().parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+            unsigned char* scratch = warpedRows.data() + tile * rowBytes;
+            int endY = std::min(height, (tile + 1) * TILE_ROWS);
+            for (int y = tile * TILE_ROWS; y < endY; y++) {
+                size_t offset = y * rowBytes;
+                const unsigned char* pastRow = past + offset;
+
+                if (warped) {
+                    int sourceY = static_cast<int>(std::floor(centerY + (y - centerY) / scale + shift + 0.5f));
+                    const unsigned char* sourceRow = past + rack::math::clamp(sourceY, 0, height - 1) * rowBytes;
+                    for (int x = 0; x < width; x++) {
+                        std::memcpy(scratch + x * 4, sourceRow + sourceColumns[x] * 4, 4);
+                    }
+                    pastRow = scratch;
+                }
+
+                // Blended into the frame and recorded for later frames at once
+                kernels.mixRows(frame.data() + offset, pastRow, frame.data() + offset, record + offset, rowBytes, weight);
+            }
+        });
+    }
+
+    // The frame just written becomes the newest, the oldest slot is reused next
+    std::rotate(history.begin(), history.end() - 1, history.end());
+    filled = std::min(filled + 1, HISTORY_FRAMES);
+}
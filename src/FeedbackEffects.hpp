@@ -0,0 +1,36 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <array>
+
+using namespace rack;
+
+// Video feedback: every rendered frame is mixed with an earlier output, which
+// was itself mixed with the one before, so images leave decaying trails.
+// Past outputs live in one preallocated block; the ring only rotates
+// pointers into it, a frame is never copied into the history.
+struct FeedbackEffects {
+    // Outputs kept for echo, the longest usable delay
+    static constexpr int HISTORY_FRAMES = 8;
+
+    // feedback in 0..1 is how much of the past output stays, 0 skips the
+    // stage. zoom and drift in -1..1 scale and scroll the past output before
+    // mixing. delay picks the output fed back, 1 is the previous one.
+    void apply(std::vector<unsigned char>& frame, int width, int height,
+               float feedback, float zoom, float drift, int delay);
+    // Forget the history, e.g. when another image is loaded
+    void clear() { filled = 0; }
+
+private:
+    std::vector<unsigned char> storage;
+    // history[0] is the newest output; the extra slot is the one being written
+    std::array<unsigned char*, HISTORY_FRAMES + 1> history{};
+    int filled{0};
+    int width{0};
+    int height{0};
+    // Source column of the zoomed history for each output column
+    std::vector<int> sourceColumns;
+    std::vector<unsigned char> warpedRows;
+
+    void allocate(int frameWidth, int frameHeight);
+};
@@ -0,0 +1,145 @@
+#include "FixedPointPipeline.hpp"
+#include "GIFGlitcher.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Same matrix as the float path
+const int bayer8x8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+const int ONE = 256;
+
+int16_t toFixed(float value) {
+    return static_cast<int16_t>(std::lround(value * ONE));
+}
+
+// Factors are stored shifted so mulFixed in the row kernels needs a
+// single shift: a * k >> 8 for |a| < 4096 and |k| < 4 (8.8 factor below 1024)
+int16_t toFactor(float value) {
+    return static_cast<int16_t>(toFixed(value) << 5);
+}
+
+} // end anonymous namespace
+
+bool FixedPointPipeline::supports(const ProcessingParams& params) {
+    return params.hueShift == 0.0f
+        && params.pixelation <= 0.0f
+        && params.rgbAberration <= 0.0f
+        && params.sharpness <= 0.0f
+        && params.edgeDetect <= 0.0f
+        && params.glitchSlice <= 0.0f
+        && params.glitchArtifacts <= 0.0f
+        && params.dataShift <= 0.0f
+        && params.pixelSort <= 0.0f;
+}
+
+void FixedPointPipeline::prepare(const ProcessingParams& params, int frameWidth, int frameHeight, int lineOffset) {
+    width = frameWidth;
+    height = frameHeight;
+    mirror = params.mirrorEffect;
+    halfMirror = params.halfMirrorEffect;
+    flip = params.flipEffect;
+    halfMirrorVertical = params.halfMirrorVerticalEffect;
+
+    adjustLevels = params.contrast != 1.0f || params.brightness != 1.0f;
+    contrast = toFactor(params.contrast);
+    levelOffset = toFixed(0.5f + (params.brightness - 1.0f));
+
+    // With the hue unchanged, scaling HSV saturation moves each channel
+    // linearly away from the max: c' = v - s * (v - c)
+    saturate = params.saturation != 1.0f;
+    saturation = toFactor(params.saturation);
+
+    float levelCount = params.posterize > 0.0f ? 2.0f + params.posterize * 14.0f : 0.0f;
+    posterize = levelCount > 0.0f;
+    if (posterize) {
+        levels = toFixed(levelCount);
+        // 256 / levels, scaled for a mulhi with the level shifted left by 9
+        levelStep = static_cast<int16_t>(std::lround(32768.0f / levelCount));
+    }
+
+    dither = params.ditherEffect;
+    if (dither) {
+        float strength = posterize ? params.ditherIntensity / levelCount : params.ditherIntensity * 0.2f;
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                ditherTable[y][x] = toFixed((bayer8x8[y][x] / 64.0f - 0.5f) * strength);
+            }
+        }
+    }
+
+    int bits = 8 - static_cast<int>(params.bitCrush * 7.f);
+    bitCrush = params.bitCrush > 0.0f && bits < 8;
+    bitMask = static_cast<int16_t>(0xFF << (8 - bits));
+
+    interlace = params.interlaceEffect;
+    interlaceOffset = lineOffset;
+    interlaceGain = toFactor(1.0f - params.interlaceIntensity);
+
+    noise = params.noise > 0.0f;
+    // A lane of random int16 times this, >> 16, spans +-noise / 2
+    noiseGain = toFixed(params.noise);
+    if (noise) {
+        for (auto& state : noiseState) {
+            state = random::u32() | 1;
+        }
+    }
+
+    invert = params.invertColors;
+
+    size_t paddedBytes = static_cast<size_t>((width + 7) & ~7) * 4;
+    sourceRow.assign(paddedBytes, 0);
+    outputRow.resize(paddedBytes);
+}
+
+void FixedPointPipeline::renderRow(const unsigned char* source, int y, unsigned char* output) {
+    // Same source coordinates as GIFGlitcher::loadSourceRow
+    int sourceY = y;
+    if (flip || (halfMirrorVertical && y >= height / 2)) {
+        sourceY = height - 1 - y;
+    }
+    const unsigned char* row = source + static_cast<size_t>(sourceY) * width * 4;
+    if (mirror || halfMirror) {
+        int firstMirrored = mirror ? 0 : width / 2;
+        std::memcpy(sourceRow.data(), row, static_cast<size_t>(firstMirrored) * 4);
+        for (int x = firstMirrored; x < width; x++) {
+            std::memcpy(sourceRow.data() + x * 4, row + (width - 1 - x) * 4, 4);
+        }
+    } else {
+        std::memcpy(sourceRow.data(), row, static_cast<size_t>(width) * 4);
+    }
+
+    FixedPointRow constants;
+    constants.adjustLevels = adjustLevels;
+    constants.contrast = contrast;
+    constants.levelOffset = levelOffset;
+    constants.saturate = saturate;
+    constants.saturation = saturation;
+    constants.dither = dither ? ditherTable[y % 8].data() : nullptr;
+    constants.posterize = posterize;
+    constants.levels = levels;
+    constants.levelStep = levelStep;
+    constants.bitCrush = bitCrush;
+    constants.bitMask = bitMask;
+    constants.interlace = interlace && (y + interlaceOffset) % 2 == 0;
+    constants.interlaceGain = interlaceGain;
+    constants.noise = noise;
+    constants.noiseGain = noiseGain;
+    constants.noiseState = noiseState.data();
+    constants.invert = invert;
+    simdKernels().fixedPointRow(constants, sourceRow.data(), outputRow.data(), width);
+
+    std::memcpy(output, outputRow.data(), static_cast<size_t>(width) * 4);
+}
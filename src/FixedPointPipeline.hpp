@@ -0,0 +1,64 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+using namespace rack;
+
+struct ProcessingParams;
+
+// Integer version of the per-pixel render path. Channels are 8.8 fixed
+// point in 16-bit lanes (1.0 is 256) and every stage uses saturating
+// integer arithmetic; the row loop is SimdKernels::fixedPointRow, which
+// holds two RGBA pixels per register on SSE2, four on AVX2 and eight on
+// AVX-512. Covers
+// mirror/flip, brightness, contrast, saturation, dither, posterize, bit
+// crush, interlace, noise and invert; frames that need any other stage keep
+// using the float path.
+struct FixedPointPipeline {
+    // True if every active stage of params has a fixed point version
+    static bool supports(const ProcessingParams& params);
+
+    // Turn params into fixed point constants for the next rows.
+    // interlaceOffset is the line parity of the interlace effect.
+    void prepare(const ProcessingParams& params, int width, int height, int interlaceOffset);
+    // Render row y of source (the whole RGBA frame) into output, width pixels
+    void renderRow(const unsigned char* source, int y, unsigned char* output);
+
+private:
+    int width{0};
+    int height{0};
+    bool mirror{false};
+    bool halfMirror{false};
+    bool flip{false};
+    bool halfMirrorVertical{false};
+
+    // Constants below are 8.8 unless noted; the scale of the factors is
+    // pre-shifted for mulFixed
+    bool adjustLevels{false};
+    int16_t contrast{0};
+    int16_t levelOffset{0};
+    bool saturate{false};
+    int16_t saturation{0};
+    bool dither{false};
+    // Dither offset per Bayer cell, [y % 8][x % 8]
+    std::array<std::array<int16_t, 8>, 8> ditherTable{};
+    bool posterize{false};
+    int16_t levels{0};
+    int16_t levelStep{0};
+    bool bitCrush{false};
+    int16_t bitMask{0};
+    bool interlace{false};
+    int interlaceOffset{0};
+    int16_t interlaceGain{0};
+    bool noise{false};
+    int16_t noiseGain{0};
+    bool invert{false};
+    // xorshift32 state, one generator per 32-bit lane
+    std::array<uint32_t, 4> noiseState{};
+
+    // Source row after mirroring and the rendered row, padded to 8 pixels
+    std::vector<unsigned char> sourceRow;
+    std::vector<unsigned char> outputRow;
+};
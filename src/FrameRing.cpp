@@ -0,0 +1,305 @@
+#include "FrameRing.hpp"
+#include <chrono>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#if defined __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <ctime>
+#endif
+
+namespace {
+
+constexpr size_t HEADER_BYTES = sizeof(FrameRingHeader);
+constexpr size_t SLOT_HEADER_BYTES = sizeof(FrameRingSlot);
+
+#if defined __linux__
+// Shared futexes (no FUTEX_PRIVATE_FLAG): the word lives in a segment
+// other processes map too
+void wakeAll(const std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, &word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void waitOn(const std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+    timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, &word, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+// A segment left behind (a crash, an old patch) may still have readers:
+// tell them to let go before it is replaced
+void retireSegment(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= HEADER_BYTES) {
+        void* map = mmap(nullptr, HEADER_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            FrameRingHeader* header = static_cast<FrameRingHeader*>(map);
+            if (header->magic == FRAME_RING_MAGIC) {
+                header->closed.store(1, std::memory_order_release);
+                header->notify.fetch_add(1, std::memory_order_release);
+                wakeAll(header->notify);
+            }
+            munmap(map, HEADER_BYTES);
+        }
+    }
+    ::close(fd);
+    shm_unlink(name.c_str());
+}
+#endif
+
+} // end anonymous namespace
+
+uint64_t frameRingNow() {
+    // CLOCK_MONOTONIC on Linux, comparable between processes
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::vector<std::string> listFrameRings() {
+    std::vector<std::string> names;
+#if defined __linux__
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) return names;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        std::string name = std::string("/") + entry->d_name;
+        FrameRingReader reader;
+        if (reader.open(name) && !reader.isClosed()) {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+#endif
+    return names;
+}
+
+FrameRingWriter::~FrameRingWriter() {
+    close();
+}
+
+bool FrameRingWriter::open(const std::string& segmentName, int width, int height, uint32_t slotCount) {
+    close();
+    if (width <= 0 || height <= 0 || slotCount < 2) return false;
+
+#if defined __linux__
+    retireSegment(segmentName);
+
+    uint64_t pixelCapacity = static_cast<uint64_t>(width) * height * 4;
+    // Slots start on a cache line
+    uint64_t slotBytes = (SLOT_HEADER_BYTES + pixelCapacity + 63) & ~uint64_t(63);
+    size_t size = HEADER_BYTES + slotBytes * slotCount;
+
+    int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+
+    // The segment starts zeroed; magic goes last so a reader attaching
+    // right now does not take a half written header
+    header = static_cast<FrameRingHeader*>(map);
+    header->layoutVersion = FRAME_RING_LAYOUT_VERSION;
+    header->slotCount = slotCount;
+    header->headerBytes = static_cast<uint32_t>(HEADER_BYTES);
+    header->slotBytes = slotBytes;
+    header->pixelCapacity = pixelCapacity;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = FRAME_RING_MAGIC;
+
+    name = segmentName;
+    mapSize = size;
+    slots = slotCount;
+    return true;
+#else
+    (void) segmentName;
+    return false;
+#endif
+}
+
+void FrameRingWriter::close() {
+    if (!header) return;
+#if defined __linux__
+    header->closed.store(1, std::memory_order_release);
+    header->notify.fetch_add(1, std::memory_order_release);
+    wakeAll(header->notify);
+    munmap(header, mapSize);
+    shm_unlink(name.c_str());
+#endif
+    header = nullptr;
+    mapSize = 0;
+}
+
+bool FrameRingWriter::publish(const unsigned char* pixels, int width, int height) {
+    if (!header || width <= 0 || height <= 0) return false;
+
+    uint64_t bytes = static_cast<uint64_t>(width) * height * 4;
+    if (bytes > header->pixelCapacity) {
+        // Readers follow the name to the new segment; numbering goes on
+        std::string segmentName = name;
+        if (!open(segmentName, width, height, slots)) return false;
+    }
+
+    uint64_t frame = ++sequence;
+    unsigned char* base = reinterpret_cast<unsigned char*>(header) + header->headerBytes
+                          + (frame % header->slotCount) * header->slotBytes;
+    FrameRingSlot* slot = reinterpret_cast<FrameRingSlot*>(base);
+
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(base + SLOT_HEADER_BYTES, pixels, bytes);
+    slot->width = static_cast<uint32_t>(width);
+    slot->height = static_cast<uint32_t>(height);
+    slot->timestampNs = frameRingNow();
+    slot->sequence.store(frame, std::memory_order_release);
+
+    header->latest.store(frame, std::memory_order_release);
+    header->notify.fetch_add(1, std::memory_order_release);
+#if defined __linux__
+    wakeAll(header->notify);
+#endif
+    return true;
+}
+
+FrameRingReader::~FrameRingReader() {
+    close();
+}
+
+bool FrameRingReader::open(const std::string& segmentName) {
+    close();
+
+#if defined __linux__
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_BYTES) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    // The header comes from another process: check every bound on its own,
+    // so no sum or product of its fields can wrap round and pass
+    const FrameRingHeader* candidate = static_cast<const FrameRingHeader*>(map);
+    bool valid = candidate->magic == FRAME_RING_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t headerBytes = candidate->headerBytes;
+    uint64_t slotBytes = candidate->slotBytes;
+    uint64_t slotCount = candidate->slotCount;
+    uint64_t pixelCapacity = candidate->pixelCapacity;
+    valid = valid && candidate->layoutVersion == FRAME_RING_LAYOUT_VERSION
+            && slotCount >= 2 && headerBytes >= HEADER_BYTES && headerBytes <= size
+            && slotBytes <= (size - headerBytes) / slotCount
+            && slotBytes >= SLOT_HEADER_BYTES
+            && pixelCapacity <= slotBytes - SLOT_HEADER_BYTES;
+    if (!valid) {
+        munmap(map, size);
+        return false;
+    }
+
+    header = candidate;
+    mapSize = size;
+    // Kept from the checked header: the fields in the segment could change
+    layout = {headerBytes, slotBytes, slotCount, pixelCapacity};
+    return true;
+#else
+    (void) segmentName;
+    return false;
+#endif
+}
+
+void FrameRingReader::close() {
+    if (!header) return;
+#if defined __linux__
+    munmap(const_cast<FrameRingHeader*>(header), mapSize);
+#endif
+    header = nullptr;
+    mapSize = 0;
+}
+
+bool FrameRingReader::isClosed() const {
+    return !header || header->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool FrameRingReader::wait(uint64_t after, int timeoutMs) const {
+    if (!header) return false;
+#if defined __linux__
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        uint32_t notify = header->notify.load(std::memory_order_acquire);
+        if (header->latest.load(std::memory_order_acquire) > after) return true;
+        if (isClosed()) return false;
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return false;
+        // Returns at once if a frame went out since notify was read
+        waitOn(header->notify, notify, static_cast<int>(left));
+    }
+#else
+    (void) after;
+    (void) timeoutMs;
+    return false;
+#endif
+}
+
+const FrameRingSlot* FrameRingReader::slot(uint64_t sequence) const {
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(header) + layout.headerBytes
+                                + (sequence % layout.slotCount) * layout.slotBytes;
+    return reinterpret_cast<const FrameRingSlot*>(base);
+}
+
+bool FrameRingReader::latest(Frame& frame) const {
+    if (!header) return false;
+
+    // A writer far ahead may lap the slot between the two loads; the next
+    // latest is then in another slot
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint64_t sequence = header->latest.load(std::memory_order_acquire);
+        if (sequence == 0) return false;
+
+        const FrameRingSlot* s = slot(sequence);
+        if (s->sequence.load(std::memory_order_acquire) != sequence) continue;
+        int width = static_cast<int>(s->width);
+        int height = static_cast<int>(s->height);
+        uint64_t timestamp = s->timestampNs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        if (width <= 0 || height <= 0 || static_cast<uint64_t>(width) * height * 4 > layout.pixelCapacity) {
+            return false;
+        }
+        frame.pixels = reinterpret_cast<const unsigned char*>(s) + SLOT_HEADER_BYTES;
+        frame.width = width;
+        frame.height = height;
+        frame.sequence = sequence;
+        frame.timestampNs = timestamp;
+        return true;
+    }
+    return false;
+}
+
+bool FrameRingReader::isIntact(const Frame& frame) const {
+    if (!header || frame.sequence == 0) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(frame.sequence)->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Frames shared with other processes on the same machine through a POSIX
+// shared memory segment (Linux only). This header and FrameRing.cpp do not
+// depend on Rack, so the tools in tools/ and outside programs can build
+// them as they are.
+//
+// Layout of the segment, all little endian, offsets in bytes:
+//
+//   0    FrameRingHeader (128 bytes)
+//   128  slot 0: FrameRingSlot (64 bytes) followed by pixelCapacity bytes
+//        of pixels, slotBytes in total
+//   ...  slot 1 .. slotCount - 1, every slotBytes
+//
+// Frame n (counting from 1) goes to slot n % slotCount. Pixels are RGBA,
+// 8 bits per channel, rows top to bottom with no padding.
+//
+// A slot is written seqlock style: its sequence is set to 0, the pixels and
+// fields are written, then the sequence is set to the frame number and the
+// header's latest follows. A reader takes latest, reads the slot and checks
+// that the slot sequence still matches afterwards; if not, the writer came
+// round and the frame is torn. After every frame the writer increments
+// notify and does a FUTEX_WAKE on it, so readers can FUTEX_WAIT on that
+// word instead of polling.
+//
+// Segments are sized for the first frame. A larger frame makes the writer
+// set closed, wake the readers and unlink the segment, then create a new
+// one under the same name; readers seeing closed open the name again.
+
+static constexpr uint32_t FRAME_RING_MAGIC = 0x52464747;  // "GGFR"
+static constexpr uint32_t FRAME_RING_LAYOUT_VERSION = 1;
+
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t layoutVersion;
+    uint32_t slotCount;
+    uint32_t headerBytes;     // Offset of slot 0
+    uint64_t slotBytes;       // Distance between slots, slot header included
+    uint64_t pixelCapacity;   // Pixel bytes that fit in a slot
+    std::atomic<uint32_t> notify;
+    std::atomic<uint32_t> closed;
+    std::atomic<uint64_t> latest;  // Newest complete frame, 0 before the first
+    uint8_t reserved[80];
+};
+
+struct FrameRingSlot {
+    std::atomic<uint64_t> sequence;  // Frame in the slot, 0 while written
+    uint32_t width;
+    uint32_t height;
+    uint64_t timestampNs;  // CLOCK_MONOTONIC when the frame was published
+    uint8_t reserved[40];
+};
+
+static_assert(sizeof(FrameRingHeader) == 128, "documented header size");
+static_assert(sizeof(FrameRingSlot) == 64, "documented slot header size");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "atomics shared between processes");
+
+// Publishes frames. One writer per segment name.
+struct FrameRingWriter {
+    static constexpr uint32_t DEFAULT_SLOTS = 4;
+
+    FrameRingWriter() = default;
+    ~FrameRingWriter();
+    FrameRingWriter(const FrameRingWriter&) = delete;
+    FrameRingWriter& operator=(const FrameRingWriter&) = delete;
+
+    // name is a shm_open name such as "/gifglitcher-1234". Creates the
+    // segment for frames up to width x height, replacing a stale one.
+    bool open(const std::string& name, int width, int height, uint32_t slotCount = DEFAULT_SLOTS);
+    // Marks the segment closed and unlinks it
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    const std::string& getName() const { return name; }
+    uint64_t getSequence() const { return sequence; }
+
+    // Copies the frame into the next slot and wakes the readers. A frame
+    // larger than the segment moves everything to a new segment.
+    bool publish(const unsigned char* pixels, int width, int height);
+
+private:
+    std::string name;
+    FrameRingHeader* header{nullptr};
+    size_t mapSize{0};
+    uint32_t slots{DEFAULT_SLOTS};
+    uint64_t sequence{0};
+};
+
+// Attaches to a segment published by someone else. Frames are read in place.
+struct FrameRingReader {
+    struct Frame {
+        const unsigned char* pixels{nullptr};
+        int width{0};
+        int height{0};
+        uint64_t sequence{0};
+        uint64_t timestampNs{0};
+    };
+
+    FrameRingReader() = default;
+    ~FrameRingReader();
+    FrameRingReader(const FrameRingReader&) = delete;
+    FrameRingReader& operator=(const FrameRingReader&) = delete;
+
+    bool open(const std::string& name);
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    // The writer went away or moved to a new segment: open the name again
+    bool isClosed() const;
+
+    // Waits until a frame newer than `after` is there, the segment closes or
+    // timeoutMs passes. Returns true for a new frame.
+    bool wait(uint64_t after, int timeoutMs) const;
+
+    // Newest complete frame. The pixels stay in the segment: check
+    // isIntact() once done with them.
+    bool latest(Frame& frame) const;
+    // False once the writer has started to overwrite the frame's slot
+    bool isIntact(const Frame& frame) const;
+
+private:
+    struct Layout {
+        uint64_t headerBytes{0};
+        uint64_t slotBytes{0};
+        uint64_t slotCount{0};
+        uint64_t pixelCapacity{0};
+    };
+
+    const FrameRingHeader* header{nullptr};
+    size_t mapSize{0};
+    Layout layout;
+
+    const FrameRingSlot* slot(uint64_t sequence) const;
+};
+
+// Monotonic clock used for the timestamps
+uint64_t frameRingNow();
+
+// Names of the segments in /dev/shm that are in this layout, sorted
+std::vector<std::string> listFrameRings();
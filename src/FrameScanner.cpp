@@ -0,0 +1,83 @@
+#include "FrameScanner.hpp"
+#include <algorithm>
+#include <cmath>
+
+void FrameScanner::store(const unsigned char* pixels, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+
+    // Nearest texel of every scale x scale block; cheap enough to run with
+    // the frame locked
+    int scale = (std::max(width, height) + MAX_SCAN_SIZE - 1) / MAX_SCAN_SIZE;
+    Frame& frame = frames[back];
+    frame.width = (width + scale - 1) / scale;
+    frame.height = (height + scale - 1) / scale;
+    frame.texels.resize(static_cast<size_t>(frame.width) * frame.height * NUM_CHANNELS);
+
+    float* texel = frame.texels.data();
+    for (int y = 0; y < frame.height; y++) {
+        int sourceY = std::min(y * scale + scale / 2, height - 1);
+        const unsigned char* row = pixels + static_cast<size_t>(sourceY) * width * 4;
+        for (int x = 0; x < frame.width; x++) {
+            const unsigned char* pixel = row + std::min(x * scale + scale / 2, width - 1) * 4;
+            texel[LUMA] = (pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) / (255.0f * 256.0f);
+            texel[RED] = pixel[0] / 255.0f;
+            texel[GREEN] = pixel[1] / 255.0f;
+            texel[BLUE] = pixel[2] / 255.0f;
+            texel += NUM_CHANNELS;
+        }
+    }
+
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+const FrameScanner::Frame& FrameScanner::latest() {
+    if (middle.load(std::memory_order_relaxed) & FRESH) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    return frames[front];
+}
+
+void FrameScanner::scanRaster(float phaseDelta, float values[NUM_CHANNELS]) {
+    const Frame& frame = latest();
+    if (frame.texels.empty()) {
+        std::fill(values, values + NUM_CHANNELS, 0.0f);
+        return;
+    }
+
+    rasterX += phaseDelta;
+    if (rasterX >= 1.0f) {
+        rasterX -= std::floor(rasterX);
+        rasterRow++;
+    }
+    // The frame may have shrunk since the last sample
+    if (rasterRow >= frame.height) {
+        rasterRow = 0;
+    }
+    read(frame, rasterX, rasterRow, values);
+}
+
+void FrameScanner::scanAt(float x, float y, float values[NUM_CHANNELS]) {
+    const Frame& frame = latest();
+    if (frame.texels.empty()) {
+        std::fill(values, values + NUM_CHANNELS, 0.0f);
+        return;
+    }
+    int row = rack::math::clamp(static_cast<int>(y * frame.height), 0, frame.height - 1);
+    read(frame, rack::math::clamp(x, 0.0f, 1.0f), row, values);
+}
+
+// Linear between the two nearest texels of the row, so a fast scan does
+// not step
+void FrameScanner::read(const Frame& frame, float x, int row, float values[NUM_CHANNELS]) {
+    float position = x * (frame.width - 1);
+    int left = std::min(static_cast<int>(position), frame.width - 1);
+    int right = std::min(left + 1, frame.width - 1);
+    float t = position - left;
+
+    const float* rowTexels = frame.texels.data() + static_cast<size_t>(row) * frame.width * NUM_CHANNELS;
+    const float* a = rowTexels + left * NUM_CHANNELS;
+    const float* b = rowTexels + right * NUM_CHANNELS;
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        values[c] = a[c] + (b[c] - a[c]) * t;
+    }
+}
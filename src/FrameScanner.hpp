@@ -0,0 +1,65 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <atomic>
+
+using namespace rack;
+
+// Reads the processed frame as CV on the audio thread. The render thread
+// stores a reduced copy of every new frame in a triple buffer: it fills the
+// back slot and swaps it with the middle one, the audio thread swaps the
+// middle one into the front when it is newer. Neither side ever waits, and
+// the audio thread only reads its front slot.
+struct FrameScanner {
+    enum Channel {
+        LUMA,
+        RED,
+        GREEN,
+        BLUE,
+        NUM_CHANNELS
+    };
+
+    // Long side of the stored copy; plenty for CV and one wavetable cycle
+    static constexpr int MAX_SCAN_SIZE = 256;
+
+    // Set by the engine while the outputs are patched; nothing is stored
+    // otherwise
+    void setActive(bool value) { active = value; }
+    bool isActive() const { return active; }
+
+    // Writer side. Callers serialise themselves (GIFGlitcher holds
+    // bufferMutex), so different threads may take turns.
+    void store(const unsigned char* pixels, int width, int height);
+
+    // Audio thread. Picks up the newest frame, then moves the raster by
+    // phaseDelta of a line (wrapping onto the next row) and reads there.
+    // Values are in [0, 1], all 0 before the first frame.
+    void scanRaster(float phaseDelta, float values[NUM_CHANNELS]);
+    // Same at a free position, x and y in [0, 1]
+    void scanAt(float x, float y, float values[NUM_CHANNELS]);
+
+private:
+    struct Frame {
+        // NUM_CHANNELS floats per texel
+        std::vector<float> texels;
+        int width{0};
+        int height{0};
+    };
+
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int FRESH = 4;
+
+    Frame frames[3];
+    // Index of the middle slot, | FRESH until the reader has taken it
+    std::atomic<int> middle{1};
+    int back{2};   // Writer only
+    int front{0};  // Reader only
+    std::atomic<bool> active{false};
+
+    // Raster position, reader only
+    float rasterX{0.0f};
+    int rasterRow{0};
+
+    const Frame& latest();
+    static void read(const Frame& frame, float x, int row, float values[NUM_CHANNELS]);
+};
@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <osdialog.h>
 #include <cstring>
+#include <climits>
+#include <chrono>
 #include "stb_image.h"
-#include "gif_lib.h"
+#include "MappedFile.hpp"
 #include <math.hpp>
 #include <rack.hpp>
 
@@ -85,11 +87,70 @@ static const int bayer8x8[8][8] = {
     { 63, 31, 55, 23, 61, 29, 53, 21 }
 };
 
+// Rows hashed per parallel tile
+const int HASH_TILE_ROWS = 64;
+
+// 64-bit hash of every row of a frame, for the display to tell which rows
+// changed. Four independent lanes so the multiplies overlap.
+void hashRows(const std::vector<unsigned char>& pixels, int width, int height, std::vector<uint64_t>& hashes) {
+    const uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    hashes.resize(height);
+
+    RenderScheduler::instance().parallelFor((height + HASH_TILE_ROWS - 1) / HASH_TILE_ROWS, [&](int tile) {
+        int endY = std::min(height, (tile + 1) * HASH_TILE_ROWS);
+        for (int y = tile * HASH_TILE_ROWS; y < endY; y++) {
+            const unsigned char* row = pixels.data() + y * rowBytes;
+            uint64_t lanes[4] = {rowBytes, 1, 2, 3};
+            size_t i = 0;
+            for (; i + 32 <= rowBytes; i += 32) {
+                for (int lane = 0; lane < 4; lane++) {
+                    uint64_t word;
+                    std::memcpy(&word, row + i + lane * 8, 8);
+                    lanes[lane] = (lanes[lane] ^ word) * MULTIPLIER;
+                    lanes[lane] ^= lanes[lane] >> 32;
+                }
+            }
+            // Rows are whole pixels, so the rest comes in 4-byte steps
+            for (; i < rowBytes; i += 4) {
+                uint32_t word;
+                std::memcpy(&word, row + i, 4);
+                lanes[0] = (lanes[0] ^ word) * MULTIPLIER;
+                lanes[0] ^= lanes[0] >> 32;
+            }
+            uint64_t hash = lanes[0];
+            for (int lane = 1; lane < 4; lane++) {
+                hash = (hash ^ lanes[lane]) * MULTIPLIER;
+                hash ^= hash >> 32;
+            }
+            hashes[y] = hash;
+        }
+    });
+}
+
+// Effects that look different on every render of the same frame
+bool hasTimeBasedEffects(const ProcessingParams& params) {
+    return params.glitchSlice > 0.0f || params.glitchArtifacts > 0.0f || params.dataShift > 0.0f
+           || params.noise > 0.0f || params.interlaceEffect
+           || params.feedback > 0.0f;
+}
+
+// Stages that keep state from one render to the next, so frames must go
+// through them in the order they are shown
+bool hasFrameHistory(const ProcessingParams& params) {
+    return params.feedback > 0.0f || params.motionMosh > 0.0f;
+}
+
 } // end anonymous namespace
 
 
 GIFGlitcher::GIFGlitcher() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+    // The module on the left writes its frames into these
+    leftExpander.producerMessage = &chainMessages[0];
+    leftExpander.consumerMessage = &chainMessages[1];
+    retiredFrames.reserve(MAX_RETIRED_FRAMES);
     configParam(BRIGHTNESS_PARAM, 0.0f, 2.0f, 1.0f, "Brightness");
     configParam(CONTRAST_PARAM, 0.0f, 2.0f, 1.0f, "Contrast");
     configParam(SATURATION_PARAM, 0.0f, 2.0f, 1.0f, "Saturation");
@@ -109,6 +170,14 @@ GIFGlitcher::GIFGlitcher() {
     configParam(BIT_CRUSH_PARAM, 0.0f, 1.0f, 0.0f, "Bit Crush");
     configParam(DATA_SHIFT_PARAM, 0.0f, 1.0f, 0.0f, "Data Shift");
     configParam(PIXEL_SORT_PARAM, 0.0f, 1.0f, 0.0f, "Pixel Sort");
+    configParam(BLUR_PARAM, 0.0f, 1.0f, 0.0f, "Blur");
+    configParam(BLOOM_PARAM, 0.0f, 1.0f, 0.0f, "Bloom");
+    configParam(GLOW_PARAM, 0.0f, 1.0f, 0.0f, "Glow");
+    configParam(FEEDBACK_PARAM, 0.0f, 1.0f, 0.0f, "Feedback");
+    configParam(FEEDBACK_ZOOM_PARAM, -1.0f, 1.0f, 0.0f, "Feedback Zoom");
+    configParam(FEEDBACK_DRIFT_PARAM, -1.0f, 1.0f, 0.0f, "Feedback Drift");
+    configParam(MOTION_MOSH_PARAM, 0.0f, 1.0f, 0.0f, "Motion Mosh");
+    configParam(GEOMETRY_PARAM, 0.0f, 1.0f, 0.0f, "Geometry Amount");
 
     configInput(BRIGHTNESS_INPUT, "Brightness CV");
     configInput(CONTRAST_INPUT, "Contrast CV");
@@ -132,59 +201,59 @@ GIFGlitcher::GIFGlitcher() {
     configInput(DATA_MOSH_INPUT, "Data Mosh CV");
     configInput(RESET_INPUT, "Reset");
     configInput(RANDOM_INPUT, "Random Effect");
-
-    threadRunning = false;
-    startWorkerThread();
+    configInput(BLUR_INPUT, "Blur CV");
+    configInput(BLOOM_INPUT, "Bloom CV");
+    configInput(GLOW_INPUT, "Glow CV");
+    configInput(FEEDBACK_INPUT, "Feedback CV");
+    configInput(FEEDBACK_ZOOM_INPUT, "Feedback Zoom CV");
+    configInput(FEEDBACK_DRIFT_INPUT, "Feedback Drift CV");
+    configInput(MOTION_MOSH_INPUT, "Motion Mosh CV");
+    configInput(GEOMETRY_INPUT, "Geometry Amount CV");
+    configInput(SCAN_CURSOR_INPUT, "Scan cursor (X, Y)");
+    configOutput(SCAN_OUTPUT, "Scan (luma, R, G, B)");
+
+    // No thread here: the shared render threads start once some instance
+    // has an image to render
 }
 
 GIFGlitcher::~GIFGlitcher() {
-    // Primero detener el thread worker
-    if (threadRunning) {
-        threadRunning = false;
-        processCV.notify_one();
-        if (workerThread.joinable()) {
-            workerThread.join();
-        }
-    }
+    // Primero sacar el módulo del scheduler; no vuelve a ejecutarse
+    suspendRendering();
 
     // Limpiar recursos
     {
         std::lock_guard<std::mutex> lock(bufferMutex);
-        if (vg) {
-            // Limpiar texturas de frames
-            for (auto& frame : gifFrames) {
-                if (frame.imageHandle) {
-                    nvgDeleteImage(vg, frame.imageHandle);
-                }
-            }
-            // Limpiar textura principal si existe
-            if (outputImageHandle) {
-                nvgDeleteImage(vg, outputImageHandle);
-            }
+        // Limpiar textura principal si existe
+        if (vg && outputImageHandle) {
+            nvgDeleteImage(vg, outputImageHandle);
         }
         outputImageHandle = 0;
         imageData.clear();
-        processedData.clear();
+        processedData = std::make_shared<std::vector<unsigned char>>();
         gifFrames.clear();
     }
 }
 
-void GIFGlitcher::startWorkerThread() {
-    if (!threadRunning) {
-        threadRunning = true;
-        processRequested = false;
-        workerThread = std::thread(&GIFGlitcher::workerFunction, this);
-    }
+void GIFGlitcher::resumeRendering() {
+    RenderScheduler::instance().resume(this);
 }
 
-void GIFGlitcher::stopWorkerThread() {
-    if (threadRunning) {
-        threadRunning = false;
-        processCV.notify_one();
-        if (workerThread.joinable()) {
-            workerThread.join();
-        }
+void GIFGlitcher::suspendRendering() {
+    RenderScheduler::instance().suspend(this);
+}
+
+void GIFGlitcher::requestRender() {
+    {
+        std::lock_guard<std::mutex> lock(paramsMutex);
+        // Any render still running for an older generation is now obsolete
+        renderGeneration++;
+        processRequested = true;
     }
+    RenderScheduler::instance().schedule(this);
+}
+
+void GIFGlitcher::requestPrerender() {
+    RenderScheduler::instance().schedule(this);
 }
 
 void GIFGlitcher::process(const ProcessArgs& args) {
@@ -210,6 +279,14 @@ void GIFGlitcher::process(const ProcessArgs& args) {
         params[BIT_CRUSH_PARAM].setValue(0.0f);
         params[DATA_SHIFT_PARAM].setValue(0.0f);
         params[PIXEL_SORT_PARAM].setValue(0.0f);
+        params[BLUR_PARAM].setValue(0.0f);
+        params[BLOOM_PARAM].setValue(0.0f);
+        params[GLOW_PARAM].setValue(0.0f);
+        params[FEEDBACK_PARAM].setValue(0.0f);
+        params[FEEDBACK_ZOOM_PARAM].setValue(0.0f);
+        params[FEEDBACK_DRIFT_PARAM].setValue(0.0f);
+        params[MOTION_MOSH_PARAM].setValue(0.0f);
+        params[GEOMETRY_PARAM].setValue(0.0f);
     }
 
     // Randomize parameters on trigger
@@ -233,6 +310,14 @@ void GIFGlitcher::process(const ProcessArgs& args) {
         params[BIT_CRUSH_PARAM].setValue(random::uniform());
         params[DATA_SHIFT_PARAM].setValue(random::uniform());
         params[PIXEL_SORT_PARAM].setValue(random::uniform());
+        params[BLUR_PARAM].setValue(random::uniform());
+        params[BLOOM_PARAM].setValue(random::uniform());
+        params[GLOW_PARAM].setValue(random::uniform());
+        params[FEEDBACK_PARAM].setValue(random::uniform());
+        params[FEEDBACK_ZOOM_PARAM].setValue(random::uniform() * 2.0f - 1.0f);
+        params[FEEDBACK_DRIFT_PARAM].setValue(random::uniform() * 2.0f - 1.0f);
+        params[MOTION_MOSH_PARAM].setValue(random::uniform());
+        params[GEOMETRY_PARAM].setValue(random::uniform());
     }
 
     // Actualizar el tiempo acumulado
@@ -271,58 +356,254 @@ void GIFGlitcher::process(const ProcessArgs& args) {
     newParams.dataShift = rack::math::clamp(params[DATA_SHIFT_PARAM].getValue() + dataMoshCv, 0.0f, 1.0f);
     newParams.pixelSort = rack::math::clamp(params[PIXEL_SORT_PARAM].getValue() + dataMoshCv, 0.0f, 1.0f);
 
+    newParams.blur = rack::math::clamp(params[BLUR_PARAM].getValue() + inputs[BLUR_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+    newParams.bloom = rack::math::clamp(params[BLOOM_PARAM].getValue() + inputs[BLOOM_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+    newParams.glow = rack::math::clamp(params[GLOW_PARAM].getValue() + inputs[GLOW_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+    newParams.motionMosh = rack::math::clamp(params[MOTION_MOSH_PARAM].getValue() + inputs[MOTION_MOSH_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+
+    // Zoom y drift son bipolares: +-5V recorren todo el rango
+    newParams.feedback = rack::math::clamp(params[FEEDBACK_PARAM].getValue() + inputs[FEEDBACK_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+    newParams.feedbackZoom = rack::math::clamp(params[FEEDBACK_ZOOM_PARAM].getValue() + inputs[FEEDBACK_ZOOM_INPUT].getVoltage() / 5.0f, -1.0f, 1.0f);
+    newParams.feedbackDrift = rack::math::clamp(params[FEEDBACK_DRIFT_PARAM].getValue() + inputs[FEEDBACK_DRIFT_INPUT].getVoltage() / 5.0f, -1.0f, 1.0f);
+    newParams.feedbackDelay = feedbackDelay;
+    newParams.fixedPoint = fixedPointRendering || getQualityLevel() >= RenderGovernor::INTEGER_KERNELS;
+    newParams.geometryMode = geometryMode;
+    newParams.geometryAmount = rack::math::clamp(params[GEOMETRY_PARAM].getValue() + inputs[GEOMETRY_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+    newParams.diffusionMode = diffusionMode;
+    newParams.scanlines = scanlineModulation;
+
+    if (scanlineModulation) {
+        scanlineModulator.push(newParams, args.sampleRate);
+    }
+
     bool paramsChanged = std::memcmp(&currentParams, &newParams, sizeof(ProcessingParams)) != 0;
 
     if (paramsChanged) {
-        std::lock_guard<std::mutex> lock(paramsMutex);
-        currentParams = newParams;
-        processRequested = true;
-        processCV.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(paramsMutex);
+            currentParams = newParams;
+            // Frames pre-rendered with the old params are no longer usable
+            paramsVersion++;
+        }
+        renderWanted = true;
     }
 
     // Actualizar animación
     if (isAnimated && !gifFrames.empty()) {
+        if (lookAheadDirty.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(bufferMutex);
+                updateLookAhead();
+            }
+            // Speed or mode changed, the upcoming frames may be different ones
+            requestPrerender();
+        }
+
         frameAccumulator += args.sampleTime * playbackSpeed;
-        float frameTime = gifFrames[currentFrame].delay / 1000.0f;
+        float frameTime = sequence ? 1.0f / sequenceFrameRate : gifFrames[currentFrame].delay / 1000.0f;
+        // Each render should be done before the next frame (or tick) is due
+        float framePeriod = std::max(frameTime / std::max(playbackSpeed, 0.01f), 1.0f / renderRate);
+        governor.setBudget(rack::math::clamp(framePeriod, MIN_RENDER_BUDGET, MAX_RENDER_BUDGET));
 
         if (frameAccumulator >= frameTime) {
-            frameAccumulator -= frameTime;
-
             // Actualizar el frame según el modo de reproducción
-            switch (playbackMode) {
-                case FORWARD:
-                    currentFrame = (currentFrame + 1) % gifFrames.size();
-                    break;
-
-                case PING_PONG:
-                    if (!playbackReverse) {
-                        currentFrame++;
-                        if (currentFrame >= gifFrames.size() - 1) {
-                            currentFrame = gifFrames.size() - 1;
-                            playbackReverse = true;
-                        }
-                    } else {
-                        currentFrame--;
-                        if (currentFrame <= 0) {
-                            currentFrame = 0;
-                            playbackReverse = false;
-                        }
+            bool reverse = playbackReverse;
+            size_t nextFrame = stepFrame(currentFrame, reverse);
+            bool frameReady = true;
+            bool prerendered = false;
+
+            {
+                std::lock_guard<std::mutex> lock(bufferMutex);
+                if (sequence) {
+                    // Swap in the prefetched frame, no decode or copy here
+                    frameReady = sequence->take(nextFrame, imageData);
+                } else {
+                    // The render thread reads the frame where it is; its
+                    // pages may still be on disk
+                    prerendered = takePrerenderedFrame(nextFrame);
+                }
+
+                if (frameReady) {
+                    currentFrame = nextFrame;
+                    playbackReverse = reverse;
+                    if (playbackMode == RANDOM) {
+                        nextRandomFrame = static_cast<size_t>(random::uniform() * gifFrames.size()) % gifFrames.size();
                     }
-                    break;
+                    updateLookAhead();
+                }
+            }
 
-                case RANDOM:
-                    currentFrame = static_cast<int>(random::uniform() * gifFrames.size());
-                    break;
+            if (frameReady) {
+                frameAccumulator -= frameTime;
+                if (prerendered) {
+                    requestPrerender();
+                } else {
+                    renderWanted = true;
+                }
+            } else {
+                // Hold the current frame until the prefetch threads catch up
+                frameAccumulator = frameTime;
             }
+        }
+    } else {
+        // Free-running stills render once per tick
+        governor.setBudget(freeRunning ? 1.0f / renderRate : RenderGovernor::DEFAULT_BUDGET);
+    }
+
+    // Los efectos que dependen del tiempo se mueven aunque no cambie nada más
+    if (freeRunning && hasTimeBasedEffects(currentParams)) {
+        renderWanted = true;
+    }
+
+    // Cadena de módulos: recibir de la izquierda, pasar a la derecha
+    receiveChainFrame();
+    sendChainFrame();
+
+    // El frame procesado como CV: luma, R, G y B de 0 a 10V
+    bool scanning = outputs[SCAN_OUTPUT].isConnected();
+    if (scanning != frameScanner.isActive()) {
+        frameScanner.setActive(scanning);
+        if (scanning) {
+            // The render thread stores the frame on its next step
+            requestPrerender();
+        }
+    }
+    if (scanning) {
+        float values[FrameScanner::NUM_CHANNELS];
+        auto& cursor = inputs[SCAN_CURSOR_INPUT];
+        if (cursor.isConnected()) {
+            // X on channel 1, Y on channel 2 (middle row if mono), 0 to 10V
+            float y = cursor.getChannels() > 1 ? cursor.getVoltage(1) / 10.0f : 0.5f;
+            frameScanner.scanAt(cursor.getVoltage(0) / 10.0f, y, values);
+        } else {
+            frameScanner.scanRaster(scanLineRate * args.sampleTime, values);
+        }
+        outputs[SCAN_OUTPUT].setChannels(FrameScanner::NUM_CHANNELS);
+        for (int c = 0; c < FrameScanner::NUM_CHANNELS; c++) {
+            outputs[SCAN_OUTPUT].setVoltage(values[c] * 10.0f, c);
+        }
+    }
 
+    // Como mucho un render por tick (dos presupuestos a media tasa); lo que
+    // cambie mientras tanto sale junto en ese render. La memoria compartida
+    // se consulta en cada tick sin pedir un render: el render thread solo
+    // renderiza si el productor publicó un frame nuevo
+    sinceRenderRequest += args.sampleTime;
+    if (renderWanted || ingestActive) {
+        float interval = 1.0f / renderRate;
+        if (getQualityLevel() >= RenderGovernor::HALF_RATE) {
+            interval = std::max(interval, 2.0f * governor.getBudget());
+        }
+        if (sinceRenderRequest >= interval) {
+            // Keep the tick phase while rendering back to back, start over after idling
+            sinceRenderRequest = sinceRenderRequest < 2.0f * interval ? sinceRenderRequest - interval : 0.0f;
             {
-                std::lock_guard<std::mutex> lock(bufferMutex);
-                imageData = getCurrentFrameData();
-                processRequested = true;
+                std::lock_guard<std::mutex> lock(paramsMutex);
+                requestedClock = accumulatedTime;
+            }
+            if (renderWanted) {
+                renderWanted = false;
+                requestRender();
+            } else {
+                // A poll must not cancel a render that is still running
+                RenderScheduler::instance().schedule(this);
+            }
+        }
+    }
+}
+
+size_t GIFGlitcher::stepFrame(size_t frame, bool& reverse) const {
+    switch (playbackMode) {
+        case FORWARD:
+            return (frame + 1) % gifFrames.size();
+
+        case PING_PONG:
+            if (!reverse) {
+                frame++;
+                if (frame >= gifFrames.size() - 1) {
+                    frame = gifFrames.size() - 1;
+                    reverse = true;
+                }
+            } else {
+                if (frame > 0) frame--;
+                if (frame == 0) {
+                    reverse = false;
+                }
             }
-            processCV.notify_one();
+            return frame;
+
+        case RANDOM:
+        default:
+            return nextRandomFrame % gifFrames.size();
+    }
+}
+
+// Called with bufferMutex held, sequence may be swapped by a load otherwise
+void GIFGlitcher::updateLookAhead() {
+    if (!sequence) return;
+
+    // Keep about LOOK_AHEAD_SECONDS of playback decoded ahead; random playback
+    // only knows its next frame
+    const float LOOK_AHEAD_SECONDS = 0.2f;
+    size_t depth = 1;
+    if (playbackMode != RANDOM) {
+        float framesAhead = std::ceil(sequenceFrameRate * playbackSpeed * LOOK_AHEAD_SECONDS);
+        depth = static_cast<size_t>(rack::math::clamp(framesAhead, 2.0f, static_cast<float>(ImageSequence::MAX_LOOK_AHEAD)));
+    }
+
+    ImageSequence::LookAhead lookAhead;
+    size_t frame = currentFrame;
+    bool reverse = playbackReverse;
+    for (size_t i = 0; i < depth; i++) {
+        frame = stepFrame(frame, reverse);
+        lookAhead.push(frame);
+    }
+    sequence->setLookAhead(lookAhead);
+}
+
+// Frames that follow the playhead, in the order they will be shown. Random
+// playback only knows the next one.
+size_t GIFGlitcher::upcomingFrames(std::array<size_t, MAX_PRERENDERED_FRAMES>& frames) const {
+    // Sequence frames only exist once the prefetch threads hand them over
+    if (!isAnimated || sequence) return 0;
+
+    size_t count = playbackMode == RANDOM ? 1 : MAX_PRERENDERED_FRAMES;
+    size_t frame = currentFrame;
+    bool reverse = playbackReverse;
+    for (size_t i = 0; i < count; i++) {
+        frame = stepFrame(frame, reverse);
+        frames[i] = frame;
+    }
+    return count;
+}
+
+// Called from process() on a frame change. Shows the pre-rendered result
+// right away if it was made with the current params.
+bool GIFGlitcher::takePrerenderedFrame(size_t frame) {
+    for (auto& prerendered : prerenderedFrames) {
+        if (prerendered.ready && prerendered.frame == frame && prerendered.paramsVersion == paramsVersion) {
+            processedData.swap(prerendered.pixels);
+            processedRowHashes.swap(prerendered.rowHashes);
+            prerendered.ready = false;
+            textureNeedsUpdate = true;
+            processedVersion++;
+            return true;
         }
     }
+
+    // Still rendering: let the render thread publish it as soon as it finishes
+    if (prerenderActive && prerenderFrame == frame && prerenderVersion == paramsVersion) {
+        prerenderPromoted = true;
+        return true;
+    }
+    return false;
+}
+
+void GIFGlitcher::clearPrerenderedFrames() {
+    for (auto& prerendered : prerenderedFrames) {
+        prerendered.ready = false;
+    }
+    prerenderPromoted = false;
 }
 
 void GIFGlitcher::loadImage(std::string path) {
@@ -333,10 +614,16 @@ void GIFGlitcher::loadImage(std::string path) {
 
     std::cout << "Loading image from path: " << path << std::endl;
 
-    // Load image using stb_image first to validate
+    // Map the file and decode it once, the same pixels are installed below
+    MappedFile file;
+    if (!file.open(path) || file.size() > static_cast<size_t>(INT_MAX)) {
+        std::cerr << "Failed to open image: " << path << std::endl;
+        return;
+    }
+
     int width, height, channels;
     stbi_set_flip_vertically_on_load(false);
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    unsigned char* data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 4);
 
     if (!data) {
         std::cerr << "Failed to load image: " << path << " - " << stbi_failure_reason() << std::endl;
@@ -352,101 +639,110 @@ void GIFGlitcher::loadImage(std::string path) {
 
     std::cout << "Image loaded successfully: " << width << "x" << height << " channels: " << channels << std::endl;
 
-    // If validation passes, update the path and trigger reload
-    imagePath = path;
-    stbi_image_free(data);
-
     if (vg) {
-        reloadImage();
+        imagePath = path;
+        sourceType = SOURCE_IMAGE;
+        installImage(data, width, height);
     } else {
         std::cerr << "No valid NVG context available" << std::endl;
     }
+    stbi_image_free(data);
 }
 
-void GIFGlitcher::reloadImage() {
+void GIFGlitcher::installImage(const unsigned char* pixels, int width, int height) {
     if (!vg) {
         std::cerr << "No valid NanoVG context" << std::endl;
         return;
     }
 
-    std::cout << "Reloading image from: " << imagePath << std::endl;
-
-    // Clear previous image if it exists
-    if (outputImageHandle) {
-        nvgDeleteImage(vg, outputImageHandle);
-        outputImageHandle = 0;
-    }
-
-    // Load the image using stb_image with explicit RGBA format
-    int channels;
-    stbi_set_flip_vertically_on_load(false);
-    unsigned char* data = stbi_load(imagePath.c_str(), &imageWidth, &imageHeight, &channels, 4);
-
-    if (!data) {
-        std::cerr << "Could not load image " << imagePath << ": " << stbi_failure_reason() << std::endl;
-        return;
-    }
-
-    try {
-        // Allocate buffers
-        size_t dataSize = static_cast<size_t>(imageWidth) * imageHeight * 4;
-        imageData.resize(dataSize);
-        processedData.resize(dataSize);
-
-        // Copy data safely
-        std::memcpy(imageData.data(), data, dataSize);
-        std::memcpy(processedData.data(), data, dataSize);
-
-        // Create NanoVG image
-        outputImageHandle = nvgCreateImageRGBA(vg, imageWidth, imageHeight, NVG_IMAGE_NEAREST, processedData.data());
+    // The render threads read imageData, keep this instance parked while the buffers change
+    suspendRendering();
 
-        if (outputImageHandle == 0) {
-            std::cerr << "Failed to create NanoVG image" << std::endl;
-            stbi_image_free(data);
-            return;
+    // Released outside bufferMutex so process() never waits on a decode or a free
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
+
+        // Clear previous image and any GIF that was playing
+        if (outputImageHandle) {
+            nvgDeleteImage(vg, outputImageHandle);
+            outputImageHandle = 0;
         }
+        gifFrames.clear();
+        currentFrame = 0;
+        frameAccumulator = 0;
+        isAnimated = false;
 
-        stbi_image_free(data);
-        std::cout << "Successfully loaded image " << imagePath
-                  << " with size " << imageWidth << "x" << imageHeight
-                  << " and handle " << outputImageHandle << std::endl;
+        try {
+            // Allocate buffers and copy the decoded pixels
+            imageWidth = width;
+            imageHeight = height;
+            size_t dataSize = static_cast<size_t>(imageWidth) * imageHeight * 4;
+            imageData.assign(pixels, pixels + dataSize);
+            processedData = std::make_shared<std::vector<unsigned char>>(imageData);
+            processedRowHashes.clear();
+
+            // The display texture is created by the next drawLayer
+            std::cout << "Successfully loaded image " << imagePath
+                      << " with size " << imageWidth << "x" << imageHeight << std::endl;
+
+        } catch (const std::exception& e) {
+            std::cerr << "Exception during image loading: " << e.what() << std::endl;
+            imageData.clear();
+            processedData = std::make_shared<std::vector<unsigned char>>();
+        }
+    }
 
-        // Force initial texture update
-        textureNeedsUpdate = true;
+    resumeRendering();
 
-    } catch (const std::exception& e) {
-        std::cerr << "Exception during image loading: " << e.what() << std::endl;
-        if (data) stbi_image_free(data);
-        outputImageHandle = 0;
-        imageData.clear();
-        processedData.clear();
-    }
+    // Force initial texture update
+    textureNeedsUpdate = true;
+    requestRender();
 }
 
-void GIFGlitcher::applyGeometricEffects(PixelInfo& pixel, int x, int y) {
-    // Determinar coordenadas fuente basadas en efectos de espejo
-    pixel.sourceX = x;
-    pixel.sourceY = y;
-
-    // Aplicar efectos de espejo horizontal
-    if (currentParams.mirrorEffect) {
-        pixel.sourceX = imageWidth - 1 - x;
-    } else if (currentParams.halfMirrorEffect && x >= imageWidth / 2) {
-        pixel.sourceX = imageWidth - 1 - x;
+template <bool Mirror, bool HalfMirror>
+void GIFGlitcher::loadSourceRow(std::vector<PixelInfo>& pixelBuffer, int y) {
+    // El espejo vertical es el mismo para toda la fila
+    int sourceY = y;
+    if (renderParams.flipEffect || (renderParams.halfMirrorVerticalEffect && y >= imageHeight / 2)) {
+        sourceY = imageHeight - 1 - y;
     }
+    const unsigned char* row = renderSource + static_cast<size_t>(sourceY) * imageWidth * 4;
 
-    // Aplicar efectos de espejo vertical
-    if (currentParams.flipEffect) {
-        pixel.sourceY = imageHeight - 1 - y;
-    } else if (currentParams.halfMirrorVerticalEffect && y >= imageHeight / 2) {
-        pixel.sourceY = imageHeight - 1 - y;
+    // Columnas [0, split) sin espejo, [split, width) espejadas
+    const int split = Mirror ? 0 : HalfMirror ? imageWidth / 2 : imageWidth;
+    for (int x = 0; x < split; ++x) {
+        PixelInfo& pixel = pixelBuffer[x];
+        pixel.sourceX = x;
+        pixel.sourceY = sourceY;
+        pixel.r = row[x * 4] / 255.0f;
+        pixel.g = row[x * 4 + 1] / 255.0f;
+        pixel.b = row[x * 4 + 2] / 255.0f;
+        pixel.a = row[x * 4 + 3] / 255.0f;
+    }
+    for (int x = split; x < imageWidth; ++x) {
+        PixelInfo& pixel = pixelBuffer[x];
+        int sourceX = imageWidth - 1 - x;
+        pixel.sourceX = sourceX;
+        pixel.sourceY = sourceY;
+        pixel.r = row[sourceX * 4] / 255.0f;
+        pixel.g = row[sourceX * 4 + 1] / 255.0f;
+        pixel.b = row[sourceX * 4 + 2] / 255.0f;
+        pixel.a = row[sourceX * 4 + 3] / 255.0f;
     }
 }
 
 void GIFGlitcher::applyPixelation(std::vector<PixelInfo>& pixelBuffer, int y) {
-    if (currentParams.pixelation <= 0.0f) return;
+    if (renderParams.pixelation <= 0.0f) return;
 
-    int pixelSize = std::max(1, static_cast<int>(currentParams.pixelation * 40.0f));
+    int pixelSize = std::max(1, static_cast<int>(renderParams.pixelation * 40.0f));
     for (int x = 0; x < imageWidth; x += pixelSize) {
         float avgR = 0.0f, avgG = 0.0f, avgB = 0.0f;
         int count = 0;
@@ -473,18 +769,18 @@ void GIFGlitcher::applyPixelation(std::vector<PixelInfo>& pixelBuffer, int y) {
 }
 
 void GIFGlitcher::applyRgbAberration(std::vector<PixelInfo>& pixelBuffer, int y) {
-    if (currentParams.rgbAberration <= 0.0f) return;
+    if (renderParams.rgbAberration <= 0.0f) return;
 
-    int shift = static_cast<int>(currentParams.rgbAberration * 20.0f);
+    int shift = static_cast<int>(renderParams.rgbAberration * 20.0f);
     for (int x = 0; x < imageWidth; ++x) {
-        int aberrationX = currentParams.mirrorEffect ?
+        int aberrationX = renderParams.mirrorEffect ?
             (pixelBuffer[x].sourceX - shift) :
             (pixelBuffer[x].sourceX + shift);
 
         if (aberrationX >= 0 && aberrationX < imageWidth) {
             int aberrationIdx = (pixelBuffer[x].sourceY * imageWidth + aberrationX) * 4;
-            float rShifted = imageData[aberrationIdx] / 255.0f;
-            pixelBuffer[x].r = pixelBuffer[x].r * (1.0f - currentParams.rgbAberration) + rShifted * currentParams.rgbAberration;
+            float rShifted = renderSource[aberrationIdx] / 255.0f;
+            pixelBuffer[x].r = pixelBuffer[x].r * (1.0f - renderParams.rgbAberration) + rShifted * renderParams.rgbAberration;
         }
     }
 }
@@ -492,17 +788,17 @@ void GIFGlitcher::applyRgbAberration(std::vector<PixelInfo>& pixelBuffer, int y)
 void GIFGlitcher::applyColorAdjustments(std::vector<PixelInfo>& pixelBuffer) {
     for (auto& pixel : pixelBuffer) {
         // Aplicar brillo y contraste
-        pixel.r = (pixel.r - 0.5f) * currentParams.contrast + 0.5f + (currentParams.brightness - 1.0f);
-        pixel.g = (pixel.g - 0.5f) * currentParams.contrast + 0.5f + (currentParams.brightness - 1.0f);
-        pixel.b = (pixel.b - 0.5f) * currentParams.contrast + 0.5f + (currentParams.brightness - 1.0f);
+        pixel.r = (pixel.r - 0.5f) * renderParams.contrast + 0.5f + (renderParams.brightness - 1.0f);
+        pixel.g = (pixel.g - 0.5f) * renderParams.contrast + 0.5f + (renderParams.brightness - 1.0f);
+        pixel.b = (pixel.b - 0.5f) * renderParams.contrast + 0.5f + (renderParams.brightness - 1.0f);
 
         // Convertir a HSV para saturación y ajuste de tono
         float h, s, v;
         rgbToHsv(pixel.r, pixel.g, pixel.b, h, s, v);
 
         // Aplicar saturación y cambio de tono
-        s *= currentParams.saturation;
-        h += currentParams.hueShift * 360.f; // Scale hue shift to 0-360 range
+        s *= renderParams.saturation;
+        h += renderParams.hueShift * 360.f; // Scale hue shift to 0-360 range
 
         // Convertir de vuelta a RGB
         hsvToRgb(h, s, v, pixel.r, pixel.g, pixel.b);
@@ -510,11 +806,11 @@ void GIFGlitcher::applyColorAdjustments(std::vector<PixelInfo>& pixelBuffer) {
 }
 
 void GIFGlitcher::applyKernelEffects(std::vector<PixelInfo>& pixelBuffer, int y) {
-    if (currentParams.edgeDetect <= 0.0f && currentParams.sharpness <= 0.0f) return;
+    if (renderParams.edgeDetect <= 0.0f && renderParams.sharpness <= 0.0f) return;
 
     std::vector<PixelInfo> edgeBuffer = pixelBuffer;
     for (int x = 1; x < imageWidth - 1; ++x) {
-        if (currentParams.edgeDetect > 0.0f) {
+        if (renderParams.edgeDetect > 0.0f) {
             float gx = 0.0f, gy = 0.0f;
             for (int i = -1; i <= 1; i++) {
                 for (int j = -1; j <= 1; j++) {
@@ -525,11 +821,11 @@ void GIFGlitcher::applyKernelEffects(std::vector<PixelInfo>& pixelBuffer, int y)
                     }
                 }
             }
-            float edge = std::sqrt(gx * gx + gy * gy) * currentParams.edgeDetect;
+            float edge = std::sqrt(gx * gx + gy * gy) * renderParams.edgeDetect;
             edgeBuffer[x].r = edgeBuffer[x].g = edgeBuffer[x].b = edge;
         }
 
-        if (currentParams.sharpness > 0.0f) {
+        if (renderParams.sharpness > 0.0f) {
             float centerR = pixelBuffer[x].r;
             float centerG = pixelBuffer[x].g;
             float centerB = pixelBuffer[x].b;
@@ -549,7 +845,7 @@ void GIFGlitcher::applyKernelEffects(std::vector<PixelInfo>& pixelBuffer, int y)
                 blurR /= validNeighbors;
                 blurG /= validNeighbors;
                 blurB /= validNeighbors;
-                float normalizedSharpness = currentParams.sharpness;
+                float normalizedSharpness = renderParams.sharpness;
                 edgeBuffer[x].r = rack::math::clamp(centerR + (centerR - blurR) * normalizedSharpness, 0.0f, 1.0f);
                 edgeBuffer[x].g = rack::math::clamp(centerG + (centerG - blurG) * normalizedSharpness, 0.0f, 1.0f);
                 edgeBuffer[x].b = rack::math::clamp(centerB + (centerB - blurB) * normalizedSharpness, 0.0f, 1.0f);
@@ -560,10 +856,10 @@ void GIFGlitcher::applyKernelEffects(std::vector<PixelInfo>& pixelBuffer, int y)
 }
 
 void GIFGlitcher::applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y) {
-    if (currentParams.glitchSlice > 0.0f) {
-        int sliceHeight = static_cast<int>(10 + currentParams.glitchSlice * 40);
-        int maxOffset = static_cast<int>(currentParams.glitchSlice * imageWidth * 0.3f);
-        int timeSlice = static_cast<int>(accumulatedTime * 10) % sliceHeight;
+    if (renderParams.glitchSlice > 0.0f) {
+        int sliceHeight = static_cast<int>(10 + renderParams.glitchSlice * 40);
+        int maxOffset = static_cast<int>(renderParams.glitchSlice * imageWidth * 0.3f);
+        int timeSlice = static_cast<int>(renderClock * 10) % sliceHeight;
 
         if ((y + timeSlice) / sliceHeight % 2 == 0) {
             int offset = static_cast<int>(random::uniform() * maxOffset);
@@ -571,22 +867,22 @@ void GIFGlitcher::applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y)
             for (int x = 0; x < imageWidth; ++x) {
                 int newX = (x + offset) % imageWidth;
                 pixelBuffer[x] = shiftedLine[newX];
-                pixelBuffer[x].r *= 1.0f + 0.2f * currentParams.glitchSlice;
-                pixelBuffer[x].b *= 1.0f - 0.1f * currentParams.glitchSlice;
+                pixelBuffer[x].r *= 1.0f + 0.2f * renderParams.glitchSlice;
+                pixelBuffer[x].b *= 1.0f - 0.1f * renderParams.glitchSlice;
             }
         }
     }
 
-    if (currentParams.glitchArtifacts > 0.0f) {
+    if (renderParams.glitchArtifacts > 0.0f) {
         const std::vector<PixelInfo> originalLine = pixelBuffer;
-        float artifactProbability = 0.05f * currentParams.glitchArtifacts;
-        int blockSize = 1 + static_cast<int>(currentParams.glitchBlockSize * 31);
+        float artifactProbability = 0.05f * renderParams.glitchArtifacts;
+        int blockSize = 1 + static_cast<int>(renderParams.glitchBlockSize * 31);
 
         for (int x = 0; x < imageWidth; x += blockSize) {
             if (random::uniform() < artifactProbability) {
                 // Si el desplazamiento está activo, decidir si desplazar/manchar o cambiar color
-                if (currentParams.glitchDisplacement > 0.0f && random::uniform() < 0.5f) {
-                    if (currentParams.glitchDisplacement > 0.5f) {
+                if (renderParams.glitchDisplacement > 0.0f && random::uniform() < 0.5f) {
+                    if (renderParams.glitchDisplacement > 0.5f) {
                         // Modo Smear
                         PixelInfo smearPixel = originalLine[x];
                         for (int bx = 0; bx < blockSize && (x + bx) < imageWidth; ++bx) {
@@ -594,7 +890,7 @@ void GIFGlitcher::applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y)
                         }
                     } else {
                         // Modo Displacement
-                        float displacementAmount = currentParams.glitchDisplacement * 2.0f; // Escalar a 0-1
+                        float displacementAmount = renderParams.glitchDisplacement * 2.0f; // Escalar a 0-1
                         float maxDisplacement = imageWidth * 0.3f * displacementAmount;
                         int xOffset = static_cast<int>((random::uniform() * 2.f - 1.f) * maxDisplacement);
 
@@ -606,7 +902,7 @@ void GIFGlitcher::applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y)
                     }
                 } else {
                     // Modo Color Shift
-                    float shiftAmount = currentParams.glitchArtifacts * 0.5f;
+                    float shiftAmount = renderParams.glitchArtifacts * 0.5f;
                     float rShift = (random::uniform() * 2.f - 1.f) * shiftAmount;
                     float gShift = (random::uniform() * 2.f - 1.f) * shiftAmount;
                     float bShift = (random::uniform() * 2.f - 1.f) * shiftAmount;
@@ -624,8 +920,8 @@ void GIFGlitcher::applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y)
 
 void GIFGlitcher::applyDataMoshEffects(std::vector<PixelInfo>& pixelBuffer, int y) {
     // Bit Crush
-    if (currentParams.bitCrush > 0.0f) {
-        int bits = 8 - static_cast<int>(currentParams.bitCrush * 7.f);
+    if (renderParams.bitCrush > 0.0f) {
+        int bits = 8 - static_cast<int>(renderParams.bitCrush * 7.f);
         if (bits < 8) {
             int mask = 0xFF << (8 - bits);
             for (auto& pixel : pixelBuffer) {
@@ -637,11 +933,11 @@ void GIFGlitcher::applyDataMoshEffects(std::vector<PixelInfo>& pixelBuffer, int
     }
 
     // Data Shift
-    if (currentParams.dataShift > 0.0f) {
+    if (renderParams.dataShift > 0.0f) {
         int blockSize = 32;
         for (int x = 0; x < imageWidth; x += blockSize) {
-            if (random::uniform() < currentParams.dataShift * 0.1f) { // Probability
-                int shift = static_cast<int>(currentParams.dataShift * 7.f); // Shift amount
+            if (random::uniform() < renderParams.dataShift * 0.1f) { // Probability
+                int shift = static_cast<int>(renderParams.dataShift * 7.f); // Shift amount
                 for (int bx = 0; bx < blockSize && (x + bx) < imageWidth; ++bx) {
                     int r = static_cast<int>(pixelBuffer[x + bx].r * 255.f);
                     int g = static_cast<int>(pixelBuffer[x + bx].g * 255.f);
@@ -657,8 +953,8 @@ void GIFGlitcher::applyDataMoshEffects(std::vector<PixelInfo>& pixelBuffer, int
     }
 
     // Pixel Sort
-    if (currentParams.pixelSort > 0.0f) {
-        float threshold = currentParams.pixelSort;
+    if (renderParams.pixelSort > 0.0f) {
+        float threshold = renderParams.pixelSort;
         int start = -1;
 
         for (int x = 0; x < imageWidth; ++x) {
@@ -677,60 +973,286 @@ void GIFGlitcher::applyDataMoshEffects(std::vector<PixelInfo>& pixelBuffer, int
     }
 }
 
-void GIFGlitcher::applyPostProcessingEffects(PixelInfo& pixel, int x, int y) {
-    if (currentParams.interlaceEffect) {
-        int lineOffset = static_cast<int>(accumulatedTime * 60) % 2;
+template <bool Interlace, bool Noise, bool Invert>
+void GIFGlitcher::storeOutputRow(const std::vector<PixelInfo>& pixelBuffer, int y, unsigned char* output) {
+    // Interlace oscurece filas enteras: un factor por fila
+    float gain = 1.0f;
+    if (Interlace) {
+        int lineOffset = static_cast<int>(renderClock * 60) % 2;
         if ((y + lineOffset) % 2 == 0) {
-            float intensity = 1.0f - currentParams.interlaceIntensity;
-            pixel.r *= intensity; pixel.g *= intensity; pixel.b *= intensity;
+            gain = 1.0f - renderParams.interlaceIntensity;
+        }
+    }
+    const float noiseAmount = renderParams.noise * 0.5f;
+
+    for (int x = 0; x < imageWidth; ++x) {
+        const PixelInfo& pixel = pixelBuffer[x];
+        float r = pixel.r, g = pixel.g, b = pixel.b;
+
+        if (Interlace) {
+            r *= gain; g *= gain; b *= gain;
+        }
+        if (Noise) {
+            r = rack::math::clamp(r + (random::uniform() * 2.0f - 1.0f) * noiseAmount, 0.0f, 1.0f);
+            g = rack::math::clamp(g + (random::uniform() * 2.0f - 1.0f) * noiseAmount, 0.0f, 1.0f);
+            b = rack::math::clamp(b + (random::uniform() * 2.0f - 1.0f) * noiseAmount, 0.0f, 1.0f);
+        }
+        if (Invert) {
+            r = 1.0f - r;
+            g = 1.0f - g;
+            b = 1.0f - b;
+        }
+
+        output[x * 4] = static_cast<unsigned char>(rack::math::clamp(r * 255.0f, 0.0f, 255.0f));
+        output[x * 4 + 1] = static_cast<unsigned char>(rack::math::clamp(g * 255.0f, 0.0f, 255.0f));
+        output[x * 4 + 2] = static_cast<unsigned char>(rack::math::clamp(b * 255.0f, 0.0f, 255.0f));
+        output[x * 4 + 3] = static_cast<unsigned char>(pixel.a * 255.0f);
+    }
+}
+
+bool GIFGlitcher::processImage(uint64_t generation, bool cancellable) {
+    std::vector<unsigned char> localImageData;
+    // From the module on the left: held, not copied, while it is rendered
+    SharedFrame chainFrame;
+    // Live sources are read in place
+    const unsigned char* source = nullptr;
+    size_t sourceSize = 0;
+    bool ingesting = ingestActive;
+    size_t frame;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (chainSourceActive || ingesting) {
+            int width = ingesting ? ingestFrame.width : chainWidth;
+            int height = ingesting ? ingestFrame.height : chainHeight;
+            if (width != imageWidth || height != imageHeight) {
+                // Only this thread renders for this module, so the buffers
+                // sized to the frame can change here
+                imageWidth = width;
+                imageHeight = height;
+                processedData = std::make_shared<std::vector<unsigned char>>();
+                processedRowHashes.clear();
+                feedbackEffects.clear();
+                motionMosh.clear();
+            }
+            if (ingesting) {
+                source = ingestFrame.pixels;
+                sourceSize = static_cast<size_t>(width) * height * 4;
+            } else if (chainSource) {
+                chainFrame = chainSource;
+                source = chainFrame->data();
+                sourceSize = chainFrame->size();
+            }
+        } else if (isAnimated && !sequence) {
+            // decodedGif only changes while rendering is suspended
+            source = decodedGif->frames[currentFrame].pixels;
+            sourceSize = decodedGif->frameSize();
+        } else {
+            localImageData = imageData;
+            source = localImageData.data();
+            sourceSize = localImageData.size();
         }
+        frame = currentFrame;
     }
+    if (!source || sourceSize == 0 || sourceSize != static_cast<size_t>(imageWidth) * imageHeight * 4) return true;
 
-    if (currentParams.noise > 0.0f) {
-        float noiseR = random::uniform() * 2.0f - 1.0f;
-        float noiseG = random::uniform() * 2.0f - 1.0f;
-        float noiseB = random::uniform() * 2.0f - 1.0f;
-        pixel.r = rack::math::clamp(pixel.r + noiseR * currentParams.noise * 0.5f, 0.0f, 1.0f);
-        pixel.g = rack::math::clamp(pixel.g + noiseG * currentParams.noise * 0.5f, 0.0f, 1.0f);
-        pixel.b = rack::math::clamp(pixel.b + noiseB * currentParams.noise * 0.5f, 0.0f, 1.0f);
+    // The producer may already have lapped the ring: come back for the newest frame
+    if (ingesting && !ingestReader.isIntact(ingestFrame)) return false;
+
+    FrameBuffer workBuffer = std::make_shared<std::vector<unsigned char>>();
+    renderingIngestFrame = ingesting;
+    bool rendered = renderFrame(source, frame, *workBuffer, generation, cancellable);
+    renderingIngestFrame = false;
+    if (!rendered) {
+        return false;
     }
+    if (ingesting) {
+        ingestSequence = ingestFrame.sequence;
+        ingestParamsVersion = renderParamsVersion;
+    }
+    std::vector<uint64_t> rowHashes;
+    hashRows(*workBuffer, imageWidth, imageHeight, rowHashes);
 
-    if (currentParams.invertColors) {
-        pixel.r = 1.0f - pixel.r;
-        pixel.g = 1.0f - pixel.g;
-        pixel.b = 1.0f - pixel.b;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        processedData = std::move(workBuffer);
+        processedRowHashes = std::move(rowHashes);
+        textureNeedsUpdate = true;
+        processedVersion++;
     }
+    return true;
 }
 
-void GIFGlitcher::processImage() {
-    if (imageData.empty()) return;
+// Render one of the next frames of a GIF while the current one is on screen,
+// so a frame change only swaps buffers. Gives up as soon as a new render is
+// requested. Returns false once there is nothing left to pre-render.
+bool GIFGlitcher::prerenderNextFrame(uint64_t generation) {
+    if (renderGeneration.load() != generation) return false;
+    // A frame rendered ahead would feed the history before the shown one,
+    // and a params change throws it away after it did
+    if (hasFrameHistory(renderParams)) return false;
+
+    size_t frame = 0;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        std::array<size_t, MAX_PRERENDERED_FRAMES> upcoming;
+        size_t count = upcomingFrames(upcoming);
+
+        bool found = false;
+        for (size_t i = 0; i < count && !found; i++) {
+            found = std::none_of(prerenderedFrames.begin(), prerenderedFrames.end(), [&](const PrerenderedFrame& prerendered) {
+                return prerendered.ready && prerendered.frame == upcoming[i]
+                       && prerendered.paramsVersion == renderParamsVersion;
+            });
+            frame = upcoming[i];
+        }
+        if (!found) return false;
+
+        prerenderActive = true;
+        prerenderFrame = frame;
+        prerenderVersion = renderParamsVersion;
+        prerenderPromoted = false;
+    }
+
+    // The recycled buffer may be a frame the module on the right still renders from
+    if (!prerenderBuffer || prerenderBuffer.use_count() > 1) {
+        prerenderBuffer = std::make_shared<std::vector<unsigned char>>();
+    }
+    // Pairs with the release of the last other handle before writing into it
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // decodedGif only changes while rendering is suspended
+    bool completed = renderFrame(decodedGif->frames[frame].pixels, frame, *prerenderBuffer, generation, true);
+    if (completed) {
+        hashRows(*prerenderBuffer, imageWidth, imageHeight, prerenderRowHashes);
+    }
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    prerenderActive = false;
+    if (!completed) return false;
+
+    if (prerenderPromoted) {
+        processedData.swap(prerenderBuffer);
+        processedRowHashes.swap(prerenderRowHashes);
+        textureNeedsUpdate = true;
+        processedVersion++;
+        prerenderPromoted = false;
+        return true;
+    }
+
+    // Reuse a slot that holds nothing still coming up
+    std::array<size_t, MAX_PRERENDERED_FRAMES> upcoming;
+    size_t count = upcomingFrames(upcoming);
+    for (auto& prerendered : prerenderedFrames) {
+        bool wanted = prerendered.ready && prerendered.paramsVersion == renderParamsVersion
+                      && std::find(upcoming.begin(), upcoming.begin() + count, prerendered.frame) != upcoming.begin() + count;
+        if (!wanted) {
+            prerendered.pixels.swap(prerenderBuffer);
+            prerendered.rowHashes.swap(prerenderRowHashes);
+            prerendered.frame = frame;
+            prerendered.paramsVersion = renderParamsVersion;
+            prerendered.ready = true;
+            break;
+        }
+    }
+    return true;
+}
 
+bool GIFGlitcher::renderFrame(const unsigned char* source, size_t frame, std::vector<unsigned char>& output,
+                              uint64_t generation, bool cancellable) {
     try {
-        std::vector<unsigned char> workBuffer(imageData.size());
-        std::vector<unsigned char> localImageData;
-        {
-            std::lock_guard<std::mutex> lock(bufferMutex);
-            localImageData = imageData;
+        output.resize(static_cast<size_t>(imageWidth) * imageHeight * 4);
+
+        // 0. Deformar la fuente con la tabla de remapeo; el resto lee el resultado
+        source = geometryRemap.apply(source, imageWidth, imageHeight, renderParams.geometryMode, renderParams.geometryAmount);
+        renderSource = source;
+
+        // With error diffusion the rows keep full precision; the levels are
+        // picked for the whole frame afterwards
+        bool diffuse = renderParams.diffusionMode != ErrorDiffusion::OFF;
+        bool posterizeRows = renderParams.posterize > 0.0f && !diffuse;
+
+        // The integer path only knows some of the effects
+        bool fixedPoint = renderParams.fixedPoint && FixedPointPipeline::supports(renderParams);
+        bool noise = renderParams.noise > 0.0f;
+
+        // Modulación por líneas: grupos de filas con sus propios valores. El
+        // camino y los kernels se eligen para todos los grupos a la vez.
+        int groups = renderParams.scanlines ? scanlineModulator.groupCount() : 0;
+        ProcessingParams frameParams = renderParams;
+        for (int group = 0; group < groups; group++) {
+            ProcessingParams groupParams = frameParams;
+            scanlineModulator.applyGroup(group, groupParams);
+            fixedPoint = fixedPoint && FixedPointPipeline::supports(groupParams);
+            noise = noise || groupParams.noise > 0.0f;
         }
 
-        const int chunkSize = 64;
+        int lineOffset = static_cast<int>(renderClock * 60) % 2;
+        auto prepareFixedPoint = [&]() {
+            ProcessingParams rowParams = renderParams;
+            if (diffuse) {
+                rowParams.posterize = 0.0f;
+            }
+            fixedPointPipeline.prepare(rowParams, imageWidth, imageHeight, lineOffset);
+        };
+        if (fixedPoint && groups == 0) {
+            prepareFixedPoint();
+        }
 
-        for (int y = 0; y < imageHeight; y += chunkSize) {
-            int endY = std::min(y + chunkSize, imageHeight);
+        // Kernels for the active flags, so their loops carry no per-pixel branches
+        static const SourceRowKernel sourceKernels[4] = {
+            &GIFGlitcher::loadSourceRow<false, false>,
+            &GIFGlitcher::loadSourceRow<false, true>,
+            &GIFGlitcher::loadSourceRow<true, false>,
+            &GIFGlitcher::loadSourceRow<true, true>,
+        };
+        static const RowKernel posterizeKernels[4] = {
+            &GIFGlitcher::applyPosterizeAndDither<false, false>,
+            &GIFGlitcher::applyPosterizeAndDither<false, true>,
+            &GIFGlitcher::applyPosterizeAndDither<true, false>,
+            &GIFGlitcher::applyPosterizeAndDither<true, true>,
+        };
+        static const OutputRowKernel outputKernels[8] = {
+            &GIFGlitcher::storeOutputRow<false, false, false>,
+            &GIFGlitcher::storeOutputRow<false, false, true>,
+            &GIFGlitcher::storeOutputRow<false, true, false>,
+            &GIFGlitcher::storeOutputRow<false, true, true>,
+            &GIFGlitcher::storeOutputRow<true, false, false>,
+            &GIFGlitcher::storeOutputRow<true, false, true>,
+            &GIFGlitcher::storeOutputRow<true, true, false>,
+            &GIFGlitcher::storeOutputRow<true, true, true>,
+        };
+        SourceRowKernel loadSource = sourceKernels[renderParams.mirrorEffect * 2 + renderParams.halfMirrorEffect];
+        RowKernel posterizeAndDither = posterizeKernels[renderParams.ditherEffect * 2 + posterizeRows];
+        OutputRowKernel storeOutput = outputKernels[renderParams.interlaceEffect * 4 + noise * 2 + renderParams.invertColors];
+        int currentGroup = -1;
+
+        for (int y = 0; y < imageHeight; y += RENDER_TILE_ROWS) {
+            // Between tiles: give up as soon as a newer render was requested
+            if (isRenderSuspended()) return false;
+            if (cancellable && renderGeneration.load(std::memory_order_relaxed) != generation) return false;
+
+            int endY = std::min(y + RENDER_TILE_ROWS, imageHeight);
 
             for (int cy = y; cy < endY; ++cy) {
+                // A cancelled render leaves a group's values in renderParams;
+                // renderStep() takes fresh ones before the next render
+                if (groups > 0 && scanlineModulator.groupForRow(cy, imageHeight) != currentGroup) {
+                    currentGroup = scanlineModulator.groupForRow(cy, imageHeight);
+                    scanlineModulator.applyGroup(currentGroup, renderParams);
+                    if (fixedPoint) {
+                        prepareFixedPoint();
+                    }
+                }
+
+                if (fixedPoint) {
+                    fixedPointPipeline.renderRow(source, cy, output.data() + static_cast<size_t>(cy) * imageWidth * 4);
+                    continue;
+                }
+
                 std::vector<PixelInfo> pixelBuffer(imageWidth);
 
                 // 1. Obtener píxeles fuente con efectos geométricos
-                for (int x = 0; x < imageWidth; ++x) {
-                    PixelInfo& pixel = pixelBuffer[x];
-                    applyGeometricEffects(pixel, x, cy);
-                    int sourceIdx = (pixel.sourceY * imageWidth + pixel.sourceX) * 4;
-                    pixel.r = localImageData[sourceIdx] / 255.0f;
-                    pixel.g = localImageData[sourceIdx + 1] / 255.0f;
-                    pixel.b = localImageData[sourceIdx + 2] / 255.0f;
-                    pixel.a = localImageData[sourceIdx + 3] / 255.0f;
-                }
+                (this->*loadSource)(pixelBuffer, cy);
 
                 // 2. Aplicar efectos de bloque (pixelación)
                 applyPixelation(pixelBuffer, cy);
@@ -742,7 +1264,7 @@ void GIFGlitcher::processImage() {
                 applyColorAdjustments(pixelBuffer);
 
                 // 5. Aplicar posterización y dither
-                applyPosterizeAndDither(pixelBuffer, cy);
+                (this->*posterizeAndDither)(pixelBuffer, cy);
 
                 // 6. Aplicar efectos de convolución/vecindad
                 applyKernelEffects(pixelBuffer, cy);
@@ -754,69 +1276,69 @@ void GIFGlitcher::processImage() {
                 applyDataMoshEffects(pixelBuffer, cy);
 
                 // 9. Aplicar efectos de post-procesamiento y guardar
-                for (int x = 0; x < imageWidth; ++x) {
-                    PixelInfo& pixel = pixelBuffer[x];
-                    applyPostProcessingEffects(pixel, x, cy);
-
-                    int currentIdx = (cy * imageWidth + x) * 4;
-                    workBuffer[currentIdx] = static_cast<unsigned char>(rack::math::clamp(pixel.r * 255.0f, 0.0f, 255.0f));
-                    workBuffer[currentIdx + 1] = static_cast<unsigned char>(rack::math::clamp(pixel.g * 255.0f, 0.0f, 255.0f));
-                    workBuffer[currentIdx + 2] = static_cast<unsigned char>(rack::math::clamp(pixel.b * 255.0f, 0.0f, 255.0f));
-                    workBuffer[currentIdx + 3] = static_cast<unsigned char>(pixel.a * 255.0f);
-                }
+                (this->*storeOutput)(pixelBuffer, cy, output.data() + static_cast<size_t>(cy) * imageWidth * 4);
             }
-
-            if (!threadRunning) return;
         }
 
-        {
-            std::lock_guard<std::mutex> lock(bufferMutex);
-            processedData = std::move(workBuffer);
-            textureNeedsUpdate = true;
+        // Las etapas de frame completo usan los valores del frame
+        renderParams = frameParams;
+
+        // 10. Difusión de error a los niveles de posterización (2 por canal sin ella)
+        if (diffuse) {
+            int levels = renderParams.posterize > 0.0f ? static_cast<int>(2.0f + renderParams.posterize * 14.0f) : 2;
+            errorDiffusion.apply(output, imageWidth, imageHeight, renderParams.diffusionMode, levels);
         }
 
+        // 11. Aplicar blur, bloom y glow sobre el frame completo
+        blurEffects.apply(output, imageWidth, imageHeight, renderParams.blur, renderParams.bloom, renderParams.glow);
+
+        // Everything up to here only read the source. A live frame the
+        // producer overwrote meanwhile is dropped before the stages below
+        // keep any of it.
+        if (renderingIngestFrame && !ingestReader.isIntact(ingestFrame)) return false;
+
+        // 12. Datamosh: mover bloques del frame anterior según el movimiento del GIF
+        motionMosh.apply(output, imageWidth, imageHeight, decodedGif, frame, renderParams.motionMosh);
+
+        // 13. Mezclar con los frames ya renderizados (feedback)
+        feedbackEffects.apply(output, imageWidth, imageHeight, renderParams.feedback,
+                              renderParams.feedbackZoom, renderParams.feedbackDrift, renderParams.feedbackDelay);
     } catch (const std::exception& e) {
         std::cerr << "Exception during image processing: " << e.what() << std::endl;
+        return false;
     }
+    return true;
 }
 
+template <bool Dither, bool Posterize>
 void GIFGlitcher::applyPosterizeAndDither(std::vector<PixelInfo>& pixelBuffer, int y) {
-    // Si ninguno de los efectos está activo, no hacer nada.
-    if (currentParams.posterize <= 0.0f && !currentParams.ditherEffect) {
+    // Sin ninguno de los dos efectos la tabla elige la versión vacía
+    if (!Dither && !Posterize) {
         return;
     }
 
-    float levels = 0.f;
-    if (currentParams.posterize > 0.0f) {
-        levels = 2.0f + (currentParams.posterize * 14.0f);
+    float levels = Posterize ? 2.0f + (renderParams.posterize * 14.0f) : 0.f;
+
+    // Ajuste del dither por columna del patrón Bayer, [0, 1) centrado en 0
+    float ditherStrength = Posterize ? (1.0f / levels) * renderParams.ditherIntensity
+                                     : renderParams.ditherIntensity * 0.2f;
+    float ditherRow[8];
+    for (int i = 0; i < 8; ++i) {
+        ditherRow[i] = (bayer8x8[y % 8][i] / 64.0f - 0.5f) * ditherStrength;
     }
 
     for (int x = 0; x < imageWidth; ++x) {
         PixelInfo& pixel = pixelBuffer[x];
 
-        if (currentParams.ditherEffect) {
-            float bayer_value = bayer8x8[y % 8][x % 8] / 64.0f; // Rango [0, 1)
-
-            if (levels > 0.f) {
-                // Dithering activo CON posterización.
-                // Añadir ajuste antes de la cuantización.
-                float dither_strength = (1.0f / levels) * currentParams.ditherIntensity;
-                float dither_adjustment = (bayer_value - 0.5f) * dither_strength;
-                pixel.r += dither_adjustment;
-                pixel.g += dither_adjustment;
-                pixel.b += dither_adjustment;
-            } else {
-                // Dithering activo SIN posterización.
-                // Aplicar un patrón de dither estilístico.
-                float dither_mod = (bayer_value - 0.5f) * currentParams.ditherIntensity * 0.2f;
-                pixel.r += dither_mod;
-                pixel.g += dither_mod;
-                pixel.b += dither_mod;
-            }
+        if (Dither) {
+            // Con posterización el ajuste va antes de la cuantización
+            float ditherAdjustment = ditherRow[x % 8];
+            pixel.r += ditherAdjustment;
+            pixel.g += ditherAdjustment;
+            pixel.b += ditherAdjustment;
         }
 
-        // Aplicar posterización si está activa
-        if (levels > 0.f) {
+        if (Posterize) {
             pixel.r = std::floor(pixel.r * levels) / levels;
             pixel.g = std::floor(pixel.g * levels) / levels;
             pixel.b = std::floor(pixel.b * levels) / levels;
@@ -825,50 +1347,293 @@ void GIFGlitcher::applyPosterizeAndDither(std::vector<PixelInfo>& pixelBuffer, i
 }
 
 
-void GIFGlitcher::workerFunction() {
-    while (threadRunning) {
-        ProcessingParams params;
-        {
-            std::unique_lock<std::mutex> lock(paramsMutex);
-            processCV.wait(lock, [this] {
-                return processRequested || !threadRunning;
-            });
+bool GIFGlitcher::renderStep() {
+    uint64_t generation;
+    bool renderRequested;
+    {
+        std::lock_guard<std::mutex> lock(paramsMutex);
+        // Always start from the newest requested state
+        renderParams = currentParams;
+        renderParamsVersion = paramsVersion;
+        renderClock = requestedClock;
+        generation = renderGeneration;
+        renderRequested = processRequested;
+        processRequested = false;
+    }
+    std::array<size_t, MAX_PRERENDERED_FRAMES> upcoming;
+    size_t upcomingCount;
+    {
+        // Frames the engine let go of since the last step
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredFrames.clear();
+        upcomingCount = upcomingFrames(upcoming);
+    }
+    prefetchFrames(upcoming, upcomingCount);
+    if (renderParams.scanlines) {
+        // One frame period of CV over the height of the frame
+        scanlineModulator.collect(governor.getBudget());
+    }
 
-            if (!threadRunning) break;
+    // From shared memory, engine polls and requests alike only render when
+    // the producer or the params moved on
+    bool render = ingestActive ? ingestFrameReady() : renderRequested;
 
-            params = currentParams;
-            processRequested = false;
+    bool more = false;
+    try {
+        if (render) {
+            // Renders cancelled in a row are bounded so a continuous CV sweep,
+            // which changes the params every sample, still gets frames out
+            bool cancellable = cancelledRenders < MAX_CANCELLED_RENDERS;
+            auto start = std::chrono::steady_clock::now();
+            if (processImage(generation, cancellable)) {
+                cancelledRenders = 0;
+                governor.recordRender(std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count());
+            } else {
+                cancelledRenders++;
+            }
+            // Come back for the newer request or to pre-render
+            more = true;
+        } else if (!ingestActive && getQualityLevel() < RenderGovernor::NO_LOOKAHEAD) {
+            // The shown frame is up to date, spend the idle time on the next
+            // ones unless the governor wants the time back
+            more = prerenderNextFrame(generation);
         }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error in render step: " << e.what() << std::endl;
+    }
 
-        try {
-            processImage();
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Error in worker thread: " << e.what() << std::endl;
-        }
+    // Whatever this step or the engine published since the last one
+    storeScanFrame();
+    publishSharedFrame();
+    return more;
+}
+
+// Render thread: have the OS read the next frames of a mapped frame cache
+// in while the current one is shown, so neither this thread nor a frame
+// change waits on the disk. Once per playhead move.
+void GIFGlitcher::prefetchFrames(const std::array<size_t, MAX_PRERENDERED_FRAMES>& frames, size_t count) {
+    if (count == 0 || (prefetchedGif.lock() == decodedGif && frames[0] == prefetchedFrame)) return;
+    prefetchedGif = decodedGif;
+    prefetchedFrame = frames[0];
+    for (size_t i = 0; i < count; i++) {
+        decodedGif->prefetch(frames[i]);
+    }
+}
+
+void GIFGlitcher::storeScanFrame() {
+    if (!frameScanner.isActive()) {
+        // Store the current frame as soon as the outputs are patched again
+        scannedVersion = UINT64_MAX;
+        return;
     }
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (scannedVersion == processedVersion) return;
+    if (processedData->size() == static_cast<size_t>(imageWidth) * imageHeight * 4) {
+        frameScanner.store(processedData->data(), imageWidth, imageHeight);
+    }
+    scannedVersion = processedVersion;
 }
 
+// Render thread: copy the newest processed frame into the shared memory
+// ring. Published buffers are never written again, so the copy runs
+// without bufferMutex.
+void GIFGlitcher::publishSharedFrame() {
+    if (!sharedMemoryOutput) {
+        if (frameRing.isOpen()) {
+            frameRing.close();
+        }
+        publishedVersion = UINT64_MAX;
+        return;
+    }
 
-GIFGlitcherWidget::~GIFGlitcherWidget() {
-    // Asegurarse de que el módulo libere sus recursos
-    if (GIFGlitcher* mod = getModule()) {
-        mod->setVG(nullptr);  // Desvincula el contexto NanoVG
+    SharedFrame frame;
+    int width, height;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (publishedVersion == processedVersion) return;
+        publishedVersion = processedVersion;
+        frame = processedData;
+        width = imageWidth;
+        height = imageHeight;
+    }
+    if (width <= 0 || height <= 0 || frame->size() != static_cast<size_t>(width) * height * 4) return;
+
+    if (!frameRing.isOpen() && !frameRing.open(sharedMemoryName(), width, height)) {
+        std::cerr << "GIFGlitcher: cannot create shared memory " << sharedMemoryName() << std::endl;
+        return;
     }
+    frameRing.publish(frame->data(), width, height);
 }
 
-GIFGlitcherWidget::GIFGlitcherWidget(GIFGlitcher* module) {
-    setModule(module);
-    box.size = Vec(RACK_GRID_WIDTH * 30, RACK_GRID_HEIGHT);
+// Engine thread: hand the newest processed frame to a GIFGlitcher on the
+// right. Only the handle moves; the one it replaces goes to retiredFrames.
+void GIFGlitcher::sendChainFrame() {
+    Module* right = rightExpander.module;
+    if (!right || right->model != modelGIFGlitcher) return;
+
+    ChainMessage* message = static_cast<ChainMessage*>(right->leftExpander.producerMessage);
+    uint64_t version = processedVersion.load(std::memory_order_relaxed);
+    if (message->version != version) {
+        // Busy, or no room for the old handle: try again next sample
+        std::unique_lock<std::mutex> lock(bufferMutex, std::try_to_lock);
+        if (!lock.owns_lock() || retiredFrames.size() == MAX_RETIRED_FRAMES) return;
+        if (message->frame) {
+            retiredFrames.push_back(std::move(message->frame));
+        }
+        message->frame = processedData;
+        message->width = imageWidth;
+        message->height = imageHeight;
+        message->version = processedVersion;
+    }
+    // Both message buffers get the frame, one flip after the other
+    right->leftExpander.requestMessageFlip();
+}
 
-    // Establecer el contexto NanoVG inmediatamente si el módulo existe
-    if (module) {
-        module->setVG(APP->window->vg);
+// Engine thread: take the frame sent by the module on the left
+void GIFGlitcher::receiveChainFrame() {
+    bool active = chainSourceActive;
+    if (active && !chainWasActive) {
+        // Whatever was taken before has been dropped since
+        chainFrameSeen = nullptr;
     }
+    chainWasActive = active;
+    if (!active) return;
 
-    setPanel(createPanel(asset::plugin(pluginInstance, "res/VCV_PANEL_30HP.svg")));
+    Module* left = leftExpander.module;
+    if (!left || left->model != modelGIFGlitcher) return;
+    const ChainMessage* message = static_cast<const ChainMessage*>(leftExpander.consumerMessage);
+    if (!message->frame || (message->version == chainVersion && message->frame.get() == chainFrameSeen)) return;
 
-    // Add screws
+    {
+        std::unique_lock<std::mutex> lock(bufferMutex, std::try_to_lock);
+        if (!lock.owns_lock() || retiredFrames.size() == MAX_RETIRED_FRAMES) return;
+        if (chainSource) {
+            retiredFrames.push_back(std::move(chainSource));
+        }
+        chainSource = message->frame;
+        chainWidth = message->width;
+        chainHeight = message->height;
+    }
+    chainVersion = message->version;
+    chainFrameSeen = message->frame.get();
+    renderWanted = true;
+}
+
+void GIFGlitcher::leaveLiveSource() {
+    chainSourceActive = false;
+    chainSource.reset();
+    ingestActive = false;
+    ingestReader.close();
+    ingestFrame = FrameRingReader::Frame();
+}
+
+void GIFGlitcher::useLeftModuleSource() {
+    suspendRendering();
+
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
+        imageData.clear();
+        processedData = std::make_shared<std::vector<unsigned char>>();
+        processedRowHashes.clear();
+        imagePath.clear();
+        // The first frame from the left sets the size
+        imageWidth = 0;
+        imageHeight = 0;
+        chainWidth = 0;
+        chainHeight = 0;
+        gifFrames.clear();
+        currentFrame = 0;
+        frameAccumulator = 0;
+        isAnimated = false;
+        sourceType = SOURCE_CHAIN;
+        chainSourceActive = true;
+    }
+
+    resumeRendering();
+}
+
+void GIFGlitcher::useSharedMemorySource(const std::string& name) {
+    suspendRendering();
+
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
+        imageData.clear();
+        processedData = std::make_shared<std::vector<unsigned char>>();
+        processedRowHashes.clear();
+        // Saved with the patch like a file path
+        imagePath = name;
+        // The first frame of the producer sets the size
+        imageWidth = 0;
+        imageHeight = 0;
+        gifFrames.clear();
+        currentFrame = 0;
+        frameAccumulator = 0;
+        isAnimated = false;
+        sourceType = SOURCE_SHARED_MEMORY;
+        ingestName = name;
+        ingestSequence = 0;
+        ingestActive = true;
+    }
+
+    // The segment is attached by the render thread on the first poll
+    resumeRendering();
+}
+
+// Render thread: attach to the producer's segment and take its newest frame.
+// Frames published while the last render ran are skipped. False when there
+// is neither a new frame nor new params to render.
+bool GIFGlitcher::ingestFrameReady() {
+    if (!ingestReader.isOpen() || ingestReader.isClosed()) {
+        // Not there yet, or the producer moved to a new segment
+        ingestFrame = FrameRingReader::Frame();
+        if (!ingestReader.open(ingestName)) return false;
+        ingestSequence = 0;
+    }
+    FrameRingReader::Frame frame;
+    if (!ingestReader.latest(frame)) return false;
+
+    bool timeBased = freeRunning && hasTimeBasedEffects(renderParams);
+    if (frame.sequence == ingestSequence && renderParamsVersion == ingestParamsVersion && !timeBased) return false;
+    ingestFrame = frame;
+    return true;
+}
+
+GIFGlitcherWidget::~GIFGlitcherWidget() {
+    // Asegurarse de que el módulo libere sus recursos
+    if (GIFGlitcher* mod = getModule()) {
+        mod->setVG(nullptr);  // Desvincula el contexto NanoVG
+    }
+}
+
+GIFGlitcherWidget::GIFGlitcherWidget(GIFGlitcher* module) {
+    setModule(module);
+    box.size = Vec(RACK_GRID_WIDTH * 30, RACK_GRID_HEIGHT);
+
+    // Establecer el contexto NanoVG inmediatamente si el módulo existe
+    if (module) {
+        module->setVG(APP->window->vg);
+    }
+
+    setPanel(createPanel(asset::plugin(pluginInstance, "res/VCV_PANEL_30HP.svg")));
+
+    // Add screws
     addChild(createWidget<ScrewSilver>(Vec(0 * RACK_GRID_WIDTH, 0)));
     addChild(createWidget<ScrewSilver>(Vec(box.size.x - 1 * RACK_GRID_WIDTH, 0)));
     addChild(createWidget<ScrewSilver>(Vec(0 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
@@ -888,6 +1653,10 @@ GIFGlitcherWidget::GIFGlitcherWidget(GIFGlitcher* module) {
     // Random Input
     addInput(createInputCentered<PJ301MPort>(Vec(resetX, 60), module, GIFGlitcher::RANDOM_INPUT));
 
+    // Scan: cursor in, luma/R/G/B out (polyphonic)
+    addInput(createInputCentered<PJ301MPort>(Vec(resetX, 95), module, GIFGlitcher::SCAN_CURSOR_INPUT));
+    addOutput(createOutputCentered<PJ301MPort>(Vec(resetX, 130), module, GIFGlitcher::SCAN_OUTPUT));
+
 
     // Add main inputs and knobs
     addInput(createInputCentered<PJ301MPort>(Vec(inputX, startY + spacing * 0), module, GIFGlitcher::BRIGHTNESS_INPUT));
@@ -934,6 +1703,35 @@ GIFGlitcherWidget::GIFGlitcherWidget(GIFGlitcher* module) {
     addParam(createParamCentered<RoundBlackKnob>(Vec(knobX + 50, startY + spacing * 10), module, GIFGlitcher::DATA_SHIFT_PARAM));
     addParam(createParamCentered<RoundBlackKnob>(Vec(knobX + 90, startY + spacing * 10), module, GIFGlitcher::PIXEL_SORT_PARAM));
 
+    // Franja de controles bajo la pantalla: knob arriba, CV debajo
+    const float stripX = 175; // X position of the first strip column
+    const float stripSpacing = 36; // Horizontal spacing between strip columns
+    const float stripKnobY = RACK_GRID_HEIGHT - 62;
+    const float stripInputY = RACK_GRID_HEIGHT - 34;
+
+    // Blur / Bloom / Glow
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 0, stripKnobY), module, GIFGlitcher::BLUR_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 0, stripInputY), module, GIFGlitcher::BLUR_INPUT));
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 1, stripKnobY), module, GIFGlitcher::BLOOM_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 1, stripInputY), module, GIFGlitcher::BLOOM_INPUT));
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 2, stripKnobY), module, GIFGlitcher::GLOW_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 2, stripInputY), module, GIFGlitcher::GLOW_INPUT));
+
+    // Feedback / Zoom / Drift
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 3, stripKnobY), module, GIFGlitcher::FEEDBACK_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 3, stripInputY), module, GIFGlitcher::FEEDBACK_INPUT));
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 4, stripKnobY), module, GIFGlitcher::FEEDBACK_ZOOM_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 4, stripInputY), module, GIFGlitcher::FEEDBACK_ZOOM_INPUT));
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 5, stripKnobY), module, GIFGlitcher::FEEDBACK_DRIFT_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 5, stripInputY), module, GIFGlitcher::FEEDBACK_DRIFT_INPUT));
+
+    // Motion Mosh
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 6, stripKnobY), module, GIFGlitcher::MOTION_MOSH_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 6, stripInputY), module, GIFGlitcher::MOTION_MOSH_INPUT));
+
+    // Geometry (el modo se elige en el menú)
+    addParam(createParamCentered<RoundBlackKnob>(Vec(stripX + stripSpacing * 7, stripKnobY), module, GIFGlitcher::GEOMETRY_PARAM));
+    addInput(createInputCentered<PJ301MPort>(Vec(stripX + stripSpacing * 7, stripInputY), module, GIFGlitcher::GEOMETRY_INPUT));
 }
 
 struct PlaybackSpeedItem : MenuItem {
@@ -1007,6 +1805,259 @@ struct PlaybackModeMenu : MenuItem {
     }
 };
 
+struct SequenceFrameRateItem : MenuItem {
+    GIFGlitcher* module;
+    float fps;
+
+    SequenceFrameRateItem(GIFGlitcher* mod, float f, const std::string& label) {
+        module = mod;
+        fps = f;
+        text = label;
+        rightText = CHECKMARK(module->getSequenceFrameRate() == fps);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setSequenceFrameRate(fps);
+    }
+};
+
+struct SequenceFrameRateMenu : MenuItem {
+    GIFGlitcher* module;
+
+    SequenceFrameRateMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Sequence Frame Rate";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        menu->addChild(new SequenceFrameRateItem(module, 12.0f, "12 fps"));
+        menu->addChild(new SequenceFrameRateItem(module, 15.0f, "15 fps"));
+        menu->addChild(new SequenceFrameRateItem(module, 24.0f, "24 fps"));
+        menu->addChild(new SequenceFrameRateItem(module, 25.0f, "25 fps"));
+        menu->addChild(new SequenceFrameRateItem(module, 30.0f, "30 fps"));
+        menu->addChild(new SequenceFrameRateItem(module, 60.0f, "60 fps"));
+        return menu;
+    }
+};
+
+struct RenderRateItem : MenuItem {
+    GIFGlitcher* module;
+    float fps;
+
+    RenderRateItem(GIFGlitcher* mod, float f, const std::string& label) {
+        module = mod;
+        fps = f;
+        text = label;
+        rightText = CHECKMARK(module->getRenderRate() == fps);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setRenderRate(fps);
+    }
+};
+
+struct RenderRateMenu : MenuItem {
+    GIFGlitcher* module;
+
+    RenderRateMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Render Rate";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        for (float fps : GIFGlitcher::RENDER_RATES) {
+            menu->addChild(new RenderRateItem(module, fps, string::f("%g fps", fps)));
+        }
+        return menu;
+    }
+};
+
+struct ScanLineRateItem : MenuItem {
+    GIFGlitcher* module;
+    float rate;
+
+    ScanLineRateItem(GIFGlitcher* mod, float r, const std::string& label) {
+        module = mod;
+        rate = r;
+        text = label;
+        rightText = CHECKMARK(module->getScanLineRate() == rate);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setScanLineRate(rate);
+    }
+};
+
+struct ScanLineRateMenu : MenuItem {
+    GIFGlitcher* module;
+
+    ScanLineRateMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Scan Line Rate";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        for (float rate : GIFGlitcher::SCAN_LINE_RATES) {
+            menu->addChild(new ScanLineRateItem(module, rate, string::f("%g Hz", rate)));
+        }
+        return menu;
+    }
+};
+
+struct FeedbackDelayItem : MenuItem {
+    GIFGlitcher* module;
+    int frames;
+
+    FeedbackDelayItem(GIFGlitcher* mod, int f, const std::string& label) {
+        module = mod;
+        frames = f;
+        text = label;
+        rightText = CHECKMARK(module->getFeedbackDelay() == frames);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setFeedbackDelay(frames);
+    }
+};
+
+struct FeedbackDelayMenu : MenuItem {
+    GIFGlitcher* module;
+
+    FeedbackDelayMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Feedback Echo";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        menu->addChild(new FeedbackDelayItem(module, 1, "1 frame"));
+        menu->addChild(new FeedbackDelayItem(module, 2, "2 frames"));
+        menu->addChild(new FeedbackDelayItem(module, 4, "4 frames"));
+        menu->addChild(new FeedbackDelayItem(module, FeedbackEffects::HISTORY_FRAMES, "8 frames"));
+        return menu;
+    }
+};
+
+struct GeometryModeItem : MenuItem {
+    GIFGlitcher* module;
+    int mode;
+
+    GeometryModeItem(GIFGlitcher* mod, int m, const std::string& label) {
+        module = mod;
+        mode = m;
+        text = label;
+        rightText = CHECKMARK(module->getGeometryMode() == mode);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setGeometryMode(mode);
+    }
+};
+
+struct DiffusionModeItem : MenuItem {
+    GIFGlitcher* module;
+    int mode;
+
+    DiffusionModeItem(GIFGlitcher* mod, int m, const std::string& label) {
+        module = mod;
+        mode = m;
+        text = label;
+        rightText = CHECKMARK(module->getDiffusionMode() == mode);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->setDiffusionMode(mode);
+    }
+};
+
+struct DiffusionModeMenu : MenuItem {
+    GIFGlitcher* module;
+
+    DiffusionModeMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Error Diffusion";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        menu->addChild(new DiffusionModeItem(module, ErrorDiffusion::OFF, "Off"));
+        menu->addChild(new DiffusionModeItem(module, ErrorDiffusion::FLOYD_STEINBERG, "Floyd-Steinberg"));
+        menu->addChild(new DiffusionModeItem(module, ErrorDiffusion::ATKINSON, "Atkinson"));
+        menu->addChild(new DiffusionModeItem(module, ErrorDiffusion::SIERRA, "Sierra"));
+        return menu;
+    }
+};
+
+struct GeometryModeMenu : MenuItem {
+    GIFGlitcher* module;
+
+    GeometryModeMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Geometry";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::NONE, "None"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::ROTATE, "Rotate"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::ZOOM, "Zoom"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::KALEIDOSCOPE, "Kaleidoscope"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::TILE, "Tile"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::POLAR, "Polar"));
+        menu->addChild(new GeometryModeItem(module, GeometryRemap::WAVE, "Wave"));
+        return menu;
+    }
+};
+
+struct SharedMemorySourceItem : MenuItem {
+    GIFGlitcher* module;
+    std::string name;
+
+    SharedMemorySourceItem(GIFGlitcher* mod, const std::string& segment) {
+        module = mod;
+        name = segment;
+        text = segment;
+        rightText = CHECKMARK(module->isSharedMemorySource() && module->getSharedMemorySourceName() == name);
+    }
+
+    void onAction(const event::Action& e) override {
+        module->useSharedMemorySource(name);
+    }
+};
+
+struct SharedMemorySourceMenu : MenuItem {
+    GIFGlitcher* module;
+
+    SharedMemorySourceMenu(GIFGlitcher* mod) {
+        module = mod;
+        text = "Shared Memory Source";
+        rightText = RIGHT_ARROW;
+    }
+
+    Menu* createChildMenu() override {
+        Menu* menu = new Menu;
+        // Every segment in the FrameRing layout except this module's own output
+        std::vector<std::string> segments = listFrameRings();
+        segments.erase(std::remove(segments.begin(), segments.end(), module->sharedMemoryName()), segments.end());
+        if (segments.empty()) {
+            menu->addChild(createMenuLabel("No segments found"));
+        }
+        for (const std::string& segment : segments) {
+            menu->addChild(new SharedMemorySourceItem(module, segment));
+        }
+        return menu;
+    }
+};
+
 void GIFGlitcherWidget::appendContextMenu(Menu* menu) {
     GIFGlitcher* module = dynamic_cast<GIFGlitcher*>(this->module);
     if (!module)
@@ -1036,11 +2087,52 @@ void GIFGlitcherWidget::appendContextMenu(Menu* menu) {
         }
     }));
 
+    menu->addChild(createMenuItem("Load Image Sequence", "", [=]() {
+        char* path = osdialog_file(OSDIALOG_OPEN_DIR, NULL, NULL, NULL);
+
+        if (path) {
+            module->loadImageSequence(path);
+            free(path);
+        }
+    }));
+
+    menu->addChild(createCheckMenuItem("Use Left Module as Source", "",
+        [=]() { return module->isChainSource(); },
+        [=]() { module->useLeftModuleSource(); }
+    ));
+#if defined ARCH_LIN
+    menu->addChild(new SharedMemorySourceMenu(module));
+#endif
+
     // Agregar los menús solo si hay un GIF cargado
     if (module->isImageLoaded() && !module->gifFrames.empty()) {
         menu->addChild(new PlaybackSpeedMenu(module));
         menu->addChild(new PlaybackModeMenu(module));
     }
+
+    if (module->isSequenceLoaded()) {
+        menu->addChild(new SequenceFrameRateMenu(module));
+    }
+
+    menu->addChild(new GeometryModeMenu(module));
+    menu->addChild(new DiffusionModeMenu(module));
+    menu->addChild(new FeedbackDelayMenu(module));
+    menu->addChild(createBoolPtrMenuItem("Fixed-point rendering", "", &module->fixedPointRendering));
+    menu->addChild(createBoolPtrMenuItem("Downscaled display", "", &module->downscaledDisplay));
+    menu->addChild(createBoolPtrMenuItem("Scanline modulation", "", &module->scanlineModulation));
+    menu->addChild(new ScanLineRateMenu(module));
+    menu->addChild(new RenderRateMenu(module));
+    menu->addChild(createBoolPtrMenuItem("Free-running render", "", &module->freeRunning));
+#if defined ARCH_LIN
+    menu->addChild(createBoolPtrMenuItem("Shared memory output", "", &module->sharedMemoryOutput));
+    if (module->sharedMemoryOutput) {
+        menu->addChild(createMenuLabel("Segment: " + module->sharedMemoryName()));
+    }
+#endif
+    menu->addChild(createBoolPtrMenuItem("Adaptive quality", "", &module->adaptiveQuality));
+    if (module->adaptiveQuality) {
+        menu->addChild(createMenuLabel(std::string("Quality: ") + RenderGovernor::levelName(module->getQualityLevel())));
+    }
 }
 
 void GIFGlitcherWidget::drawLayer(const DrawArgs& args, int layer) {
@@ -1090,14 +2182,15 @@ void GIFGlitcherWidget::drawLayer(const DrawArgs& args, int layer) {
         nvgText(args.vg, box.size.x / 2, RACK_GRID_HEIGHT - 8, "DETNOISE", NULL);
         nvgRestore(args.vg);
 
-        if (!mod->getOutputImageHandle()) return;
+        int texture = mod->updateDisplayTexture(args.vg);
+        if (!texture) return;
 
         nvgSave(args.vg);
 
         // Definir el área de visualización maximizada
         // Ajustar estos valores para aprovechar al máximo el espacio disponible
         float topMargin = 25.0f;  // Espacio para el título
-        float bottomMargin = 25.0f;  // Espacio para el texto inferior
+        float bottomMargin = 80.0f;  // Espacio para la franja de controles y el texto inferior
         float leftMargin = 150.0f;  // Espacio para los controles izquierdos
         float rightMargin = 5.0f;  // Margen derecho mínimo
 
@@ -1128,13 +2221,6 @@ void GIFGlitcherWidget::drawLayer(const DrawArgs& args, int layer) {
             posY = displayY;
         }
 
-        // Update texture if needed
-        if (mod->textureNeedsUpdate) {
-            std::lock_guard<std::mutex> lock(mod->bufferMutex);
-            nvgUpdateImage(args.vg, mod->getOutputImageHandle(), mod->getProcessedDataPtr());
-            mod->textureNeedsUpdate = false;
-        }
-
         // Dibujar un fondo para la imagen
         nvgBeginPath(args.vg);
         nvgRect(args.vg, posX - 2, posY - 2, width + 4, height + 4);
@@ -1150,7 +2236,7 @@ void GIFGlitcherWidget::drawLayer(const DrawArgs& args, int layer) {
 
         // Draw the image
         nvgBeginPath(args.vg);
-        NVGpaint imgPaint = nvgImagePattern(args.vg, posX, posY, width, height, 0, mod->getOutputImageHandle(), 1.0f);
+        NVGpaint imgPaint = nvgImagePattern(args.vg, posX, posY, width, height, 0, texture, 1.0f);
         nvgRect(args.vg, posX, posY, width, height);
         nvgFillPaint(args.vg, imgPaint);
         nvgFill(args.vg);
@@ -1174,50 +2260,36 @@ bool GIFGlitcher::loadGif(const std::string& path) {
     if (!vg) {
         INFO("GIFGlitcher: No hay contexto VG disponible, guardando path para carga posterior: %s", path.c_str());
         pendingGifPath = path;
+        pendingSourceType = SOURCE_GIF;
         hasPendingGif = true;
         return false;
     }
 
-    int error;
-    GifFileType* gif = DGifOpenFileName(path.c_str(), &error);
-    if (!gif) {
-        INFO("GIFGlitcher: Error al abrir archivo GIF: %s (error %d)", path.c_str(), error);
+    // Otras instancias con el mismo archivo comparten los frames decodificados
+    std::shared_ptr<const DecodedGif> decoded = GifCache::acquire(path);
+    if (!decoded) {
         return false;
     }
 
-    if (DGifSlurp(gif) != GIF_OK) {
-        INFO("GIFGlitcher: Error al leer contenido del GIF: %s (error %d)", path.c_str(), error);
-        DGifCloseFile(gif, &error);
-        return false;
-    }
-
-    // Verificar dimensiones del GIF
-    if (gif->SWidth <= 0 || gif->SHeight <= 0 || gif->SWidth > 4096 || gif->SHeight > 4096) {
-        INFO("GIFGlitcher: Dimensiones de GIF inválidas: %dx%d", gif->SWidth, gif->SHeight);
-        DGifCloseFile(gif, &error);
-        return false;
-    }
-
-    // Stop worker thread temporarily
-    stopWorkerThread();
+    // Suspend rendering temporarily
+    suspendRendering();
 
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
     {
         std::lock_guard<std::mutex> lock(bufferMutex);
-
-        // Clear existing resources
-        if (vg) {
-            // Limpiar texturas de frames existentes
-            for (auto& frame : gifFrames) {
-                if (frame.imageHandle) {
-                    nvgDeleteImage(vg, frame.imageHandle);
-                }
-            }
-
-            // Limpiar textura principal si existe
-            if (outputImageHandle) {
-                nvgDeleteImage(vg, outputImageHandle);
-                outputImageHandle = 0;
-            }
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
+        sourceType = SOURCE_GIF;
+
+        // Limpiar textura principal si existe
+        if (vg && outputImageHandle) {
+            nvgDeleteImage(vg, outputImageHandle);
+            outputImageHandle = 0;
         }
 
         // Clear existing frames
@@ -1225,137 +2297,141 @@ bool GIFGlitcher::loadGif(const std::string& path) {
         currentFrame = 0;
         frameAccumulator = 0;
 
-        imageWidth = gif->SWidth;
-        imageHeight = gif->SHeight;
-
-        INFO("GIFGlitcher: Dimensiones del GIF: %dx%d, %d frames",
-             imageWidth, imageHeight, gif->ImageCount);
+        decodedGif = decoded;
+        imageWidth = decoded->width;
+        imageHeight = decoded->height;
 
-        // Verificar si hay frames
-        if (gif->ImageCount <= 0) {
-            INFO("GIFGlitcher: El GIF no tiene frames");
-            DGifCloseFile(gif, &error);
-            return false;
+        // Only the playback timing is per instance; frames are drawn through
+        // the single display texture
+        for (const auto& decodedFrame : decoded->frames) {
+            GifFrame frame;
+            frame.delay = decodedFrame.delay;
+            gifFrames.push_back(frame);
         }
 
-        std::vector<unsigned char> canvas(imageWidth * imageHeight * 4, 0);
-        std::vector<unsigned char> prevCanvas(imageWidth * imageHeight * 4, 0);
+        isAnimated = gifFrames.size() > 1;
 
-        // Convert each frame
-        for (int i = 0; i < gif->ImageCount; i++) {
-            SavedImage* image = &gif->SavedImages[i];
-            GifFrame frame;
+        // Initialize with first frame
+        imageData.assign(decoded->frames[0].pixels, decoded->frames[0].pixels + decoded->frameSize());
+        processedData = std::make_shared<std::vector<unsigned char>>(imageData);
+        processedRowHashes.clear();
+        imagePath = path;
+    }
 
-            int transparentColor = -1;
-            int disposal = 0;
-            for (int j = 0; j < image->ExtensionBlockCount; j++) {
-                ExtensionBlock* eb = &image->ExtensionBlocks[j];
-                if (eb->Function == GRAPHICS_EXT_FUNC_CODE) {
-                    disposal = (eb->Bytes[0] >> 2) & 7;
-                    if (eb->Bytes[0] & 0x01)
-                        transparentColor = (int)eb->Bytes[3];
-                }
-            }
+    // Resume rendering
+    resumeRendering();
+    textureNeedsUpdate = true;
+    requestRender();
 
-            ColorMapObject* colorMap = image->ImageDesc.ColorMap ? image->ImageDesc.ColorMap : gif->SColorMap;
-
-            if (i > 0) {
-                if (disposal == DISPOSE_BACKGROUND) {
-                    for (int y = 0; y < image->ImageDesc.Height; y++) {
-                        for (int x = 0; x < image->ImageDesc.Width; x++) {
-                            int idx = ((y + image->ImageDesc.Top) * imageWidth + (x + image->ImageDesc.Left)) * 4;
-                            canvas[idx] = 0;
-                            canvas[idx + 1] = 0;
-                            canvas[idx + 2] = 0;
-                            canvas[idx + 3] = 0;
-                        }
-                    }
-                } else if (disposal == DISPOSE_PREVIOUS) {
-                    canvas = prevCanvas;
-                }
-            }
-            prevCanvas = canvas;
-
-            for (int y = 0; y < image->ImageDesc.Height; y++) {
-                for (int x = 0; x < image->ImageDesc.Width; x++) {
-                    int srcIdx = y * image->ImageDesc.Width + x;
-                    int dstIdx = ((y + image->ImageDesc.Top) * imageWidth + (x + image->ImageDesc.Left)) * 4;
-                    int colorIndex = image->RasterBits[srcIdx];
-
-                    if (colorIndex != transparentColor) {
-                        GifColorType& color = colorMap->Colors[colorIndex];
-                        canvas[dstIdx] = color.Red;
-                        canvas[dstIdx + 1] = color.Green;
-                        canvas[dstIdx + 2] = color.Blue;
-                        canvas[dstIdx + 3] = 255;
-                    }
-                }
-            }
+    INFO("GIFGlitcher: GIF cargado exitosamente: %s (%d frames)",
+         path.c_str(), (int)gifFrames.size());
+    return true;
+}
 
-            frame.data = canvas;
-            frame.delay = 100; // Default delay
-            for (int j = 0; j < image->ExtensionBlockCount; j++) {
-                ExtensionBlock* eb = &image->ExtensionBlocks[j];
-                if (eb->Function == GRAPHICS_EXT_FUNC_CODE) {
-                    int delay = ((eb->Bytes[2] << 8) | eb->Bytes[1]) * 10;
-                    if (delay > 0) {
-                        frame.delay = delay;
-                    }
-                    break;
-                }
-            }
+bool GIFGlitcher::loadImageSequence(const std::string& directory) {
+    if (directory.empty()) {
+        return false;
+    }
 
-            if (vg) {
-                frame.imageHandle = nvgCreateImageRGBA(vg, imageWidth, imageHeight, 0, frame.data.data());
-            }
-            gifFrames.push_back(frame);
+    if (!vg) {
+        INFO("GIFGlitcher: No hay contexto VG disponible, guardando secuencia para carga posterior: %s", directory.c_str());
+        imagePath = directory;
+        pendingGifPath = directory;
+        pendingSourceType = SOURCE_SEQUENCE;
+        hasPendingGif = true;
+        return false;
+    }
+
+    std::vector<std::string> paths = ImageSequence::findFrames(directory);
+    if (paths.empty()) {
+        INFO("GIFGlitcher: No se encontraron imágenes PNG/JPG en: %s", directory.c_str());
+        return false;
+    }
+
+    // The first frame fixes the size of the sequence and is shown right away
+    std::vector<unsigned char> firstFrame;
+    int width, height;
+    if (!ImageSequence::decodeFile(paths[0], firstFrame, width, height)) {
+        INFO("GIFGlitcher: Error al leer la primera imagen de la secuencia: %s", paths[0].c_str());
+        return false;
+    }
+    if (width <= 0 || height <= 0 || width > 4096 || height > 4096) {
+        INFO("GIFGlitcher: Dimensiones de secuencia inválidas: %dx%d", width, height);
+        return false;
+    }
+
+    suspendRendering();
+
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
+
+        if (vg && outputImageHandle) {
+            nvgDeleteImage(vg, outputImageHandle);
+            outputImageHandle = 0;
         }
 
+        // Frames stay on disk; gifFrames only drives the playback clock
+        gifFrames.clear();
+        gifFrames.resize(paths.size());
+        for (auto& frame : gifFrames) {
+            frame.delay = static_cast<int>(1000.0f / sequenceFrameRate);
+        }
+        currentFrame = 0;
+        frameAccumulator = 0;
+        playbackReverse = false;
+        nextRandomFrame = 0;
         isAnimated = gifFrames.size() > 1;
 
-        // Initialize with first frame
-        if (!gifFrames.empty()) {
-            imageData = gifFrames[0].data;
-            processedData = imageData;
-            imagePath = path;
-
-            if (vg) {
-                outputImageHandle = nvgCreateImageRGBA(vg, imageWidth, imageHeight, 0, processedData.data());
-                if (outputImageHandle == 0) {
-                    INFO("GIFGlitcher: Error al crear textura principal");
-                }
-            }
-        } else {
-            INFO("GIFGlitcher: No se pudieron cargar frames del GIF");
-            DGifCloseFile(gif, &error);
-            return false;
-        }
-    }
+        imageWidth = width;
+        imageHeight = height;
+        imageData = std::move(firstFrame);
+        processedData = std::make_shared<std::vector<unsigned char>>(imageData);
+        processedRowHashes.clear();
+
+        sequence = std::make_unique<ImageSequence>(std::move(paths), width, height);
+        updateLookAhead();
 
-    DGifCloseFile(gif, &error);
+        imagePath = directory;
+        sourceType = SOURCE_SEQUENCE;
+    }
 
-    // Restart worker thread
-    startWorkerThread();
+    resumeRendering();
     textureNeedsUpdate = true;
-    processRequested = true;
-    processCV.notify_one();
+    requestRender();
 
-    INFO("GIFGlitcher: GIF cargado exitosamente: %s (%d frames)",
-         path.c_str(), (int)gifFrames.size());
+    INFO("GIFGlitcher: Secuencia cargada exitosamente: %s (%d imágenes)",
+         directory.c_str(), (int)gifFrames.size());
     return true;
 }
 
 void GIFGlitcher::onReset() {
-    stopWorkerThread();
+    suspendRendering();
 
+    std::unique_ptr<ImageSequence> retiredSequence;
+    std::shared_ptr<const DecodedGif> retiredGif;
     {
         std::lock_guard<std::mutex> lock(bufferMutex);
+        retiredSequence = std::move(sequence);
+        retiredGif = std::move(decodedGif);
+        leaveLiveSource();
+        clearPrerenderedFrames();
+        feedbackEffects.clear();
+        motionMosh.clear();
         if (vg && outputImageHandle) {
             nvgDeleteImage(vg, outputImageHandle);
         }
         outputImageHandle = 0;
         imageData.clear();
-        processedData.clear();
+        processedData = std::make_shared<std::vector<unsigned char>>();
+        processedRowHashes.clear();
         imagePath.clear();
         imageWidth = 0;
         imageHeight = 0;
@@ -1365,7 +2441,113 @@ void GIFGlitcher::onReset() {
         isAnimated = false;
     }
 
-    startWorkerThread();
+    resumeRendering();
+}
+
+int GIFGlitcher::updateDisplayTexture(NVGcontext* vg) {
+    // Published frames are never written again: take a handle under the
+    // lock and downscale and upload without it, so process() never waits
+    // on the UI thread at a frame change
+    SharedFrame frame;
+    std::vector<uint64_t> rowHashes;
+    int frameWidth, frameHeight, width, height, scale = 1;
+    bool recreate, nearest;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        size_t frameBytes = static_cast<size_t>(imageWidth) * imageHeight * 4;
+        if (imageWidth <= 0 || imageHeight <= 0 || processedData->size() != frameBytes) return 0;
+
+        // Downscaled, every texel averages a scale x scale block of the frame
+        if (downscaledDisplay) {
+            int longSide = std::max(imageWidth, imageHeight);
+            scale = (longSide + MAX_DOWNSCALED_SIZE - 1) / MAX_DOWNSCALED_SIZE;
+        }
+        width = (imageWidth + scale - 1) / scale;
+        height = (imageHeight + scale - 1) / scale;
+        recreate = !outputImageHandle || width != textureWidth || height != textureHeight;
+        if (!recreate && !textureNeedsUpdate) return outputImageHandle;
+
+        frame = processedData;
+        rowHashes = processedRowHashes;
+        frameWidth = imageWidth;
+        frameHeight = imageHeight;
+        // Still images keep their hard pixel edges, as before
+        nearest = sourceType == SOURCE_IMAGE;
+        // A frame published from here on sets it again
+        textureNeedsUpdate = false;
+    }
+
+    // Texture rows whose frame rows changed; all of them if the hashes are unknown
+    bool known = !recreate && rowHashes.size() == static_cast<size_t>(frameHeight)
+                 && uploadedRowHashes.size() == static_cast<size_t>(frameHeight);
+    std::vector<bool> changed(height, true);
+    if (known) {
+        for (int row = 0; row < height; row++) {
+            int begin = row * scale;
+            int end = std::min(frameHeight, begin + scale);
+            changed[row] = !std::equal(rowHashes.begin() + begin, rowHashes.begin() + end,
+                                       uploadedRowHashes.begin() + begin);
+        }
+    }
+
+    const unsigned char* pixels = frame->data();
+    if (scale > 1) {
+        displayPixels.resize(static_cast<size_t>(width) * height * 4);
+        for (int row = 0; row < height; row++) {
+            if (!changed[row]) continue;
+            int rowEnd = std::min(frameHeight, (row + 1) * scale);
+            for (int column = 0; column < width; column++) {
+                int columnEnd = std::min(frameWidth, (column + 1) * scale);
+                int sum[4] = {0, 0, 0, 0};
+                for (int y = row * scale; y < rowEnd; y++) {
+                    const unsigned char* src = frame->data() + static_cast<size_t>(y) * frameWidth * 4;
+                    for (int x = column * scale; x < columnEnd; x++) {
+                        for (int c = 0; c < 4; c++) {
+                            sum[c] += src[x * 4 + c];
+                        }
+                    }
+                }
+                int count = (rowEnd - row * scale) * (columnEnd - column * scale);
+                unsigned char* dst = displayPixels.data() + (static_cast<size_t>(row) * width + column) * 4;
+                for (int c = 0; c < 4; c++) {
+                    dst[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+                }
+            }
+        }
+        pixels = displayPixels.data();
+    }
+
+    if (recreate) {
+        if (outputImageHandle) {
+            nvgDeleteImage(vg, outputImageHandle);
+        }
+        int flags = nearest && scale == 1 ? NVG_IMAGE_NEAREST : 0;
+        outputImageHandle = nvgCreateImageRGBA(vg, width, height, flags, pixels);
+        textureWidth = width;
+        textureHeight = height;
+        if (outputImageHandle == 0) {
+            INFO("GIFGlitcher: Error al crear textura principal");
+        }
+    } else {
+        // Upload each band of changed rows. The GL backend takes the whole
+        // image and skips to the band itself.
+        NVGparams* params = nvgInternalParams(vg);
+        for (int row = 0; row < height;) {
+            if (!changed[row]) {
+                row++;
+                continue;
+            }
+            int end = row + 1;
+            while (end < height && changed[end]) {
+                end++;
+            }
+            params->renderUpdateTexture(params->userPtr, outputImageHandle, 0, row, width, end - row, pixels);
+            row = end;
+        }
+    }
+
+    uploadedRowHashes = std::move(rowHashes);
+    return outputImageHandle;
 }
 
 void GIFGlitcher::setVG(NVGcontext* _vg) {
@@ -1373,10 +2555,28 @@ void GIFGlitcher::setVG(NVGcontext* _vg) {
 
     // Si hay un GIF pendiente de cargar y ahora tenemos el contexto, cargarlo
     if (hasPendingGif && vg) {
-        INFO("GIFGlitcher: Cargando GIF pendiente con contexto VG disponible: %s", pendingGifPath.c_str());
-        bool success = loadGif(pendingGifPath);
-        INFO("GIFGlitcher: Resultado de carga pendiente: %s", success ? "éxito" : "fallido");
+        INFO("GIFGlitcher: Cargando fuente pendiente con contexto VG disponible: %s", pendingGifPath.c_str());
         hasPendingGif = false;
+        bool success = true;
+        switch (pendingSourceType) {
+            case SOURCE_IMAGE:
+                loadImage(pendingGifPath);
+                break;
+            case SOURCE_SEQUENCE:
+                success = loadImageSequence(pendingGifPath);
+                break;
+            case SOURCE_CHAIN:
+                useLeftModuleSource();
+                break;
+            case SOURCE_SHARED_MEMORY:
+                useSharedMemorySource(pendingGifPath);
+                break;
+            case SOURCE_GIF:
+            default:
+                success = loadGif(pendingGifPath);
+                break;
+        }
+        INFO("GIFGlitcher: Resultado de carga pendiente: %s", success ? "éxito" : "fallido");
     }
 }
 
@@ -1385,9 +2585,25 @@ json_t* GIFGlitcher::dataToJson() {
     json_object_set_new(rootJ, "playbackSpeed", json_real(playbackSpeed));
     json_object_set_new(rootJ, "playbackMode", json_integer(playbackMode));
 
+    json_object_set_new(rootJ, "sequenceFrameRate", json_real(sequenceFrameRate));
+    json_object_set_new(rootJ, "feedbackDelay", json_integer(feedbackDelay));
+    json_object_set_new(rootJ, "fixedPointRendering", json_boolean(fixedPointRendering));
+    json_object_set_new(rootJ, "geometryMode", json_integer(geometryMode));
+    json_object_set_new(rootJ, "diffusionMode", json_integer(diffusionMode));
+    json_object_set_new(rootJ, "downscaledDisplay", json_boolean(downscaledDisplay));
+    json_object_set_new(rootJ, "adaptiveQuality", json_boolean(adaptiveQuality));
+    json_object_set_new(rootJ, "renderRate", json_real(renderRate));
+    json_object_set_new(rootJ, "freeRunning", json_boolean(freeRunning));
+    json_object_set_new(rootJ, "scanLineRate", json_real(scanLineRate));
+    json_object_set_new(rootJ, "scanlineModulation", json_boolean(scanlineModulation));
+    json_object_set_new(rootJ, "sharedMemoryOutput", json_boolean(sharedMemoryOutput));
+
     // Guardar el path del GIF
     if (!imagePath.empty()) {
         json_object_set_new(rootJ, "imagePath", json_string(imagePath.c_str()));
+        json_object_set_new(rootJ, "sourceType", json_integer(sourceType));
+    } else if (isChainSource()) {
+        json_object_set_new(rootJ, "sourceType", json_integer(SOURCE_CHAIN));
     }
 
     return rootJ;
@@ -1402,11 +2618,65 @@ void GIFGlitcher::dataFromJson(json_t* rootJ) {
     if (modeJ)
         playbackMode = static_cast<PlaybackMode>(json_integer_value(modeJ));
 
+    json_t* fpsJ = json_object_get(rootJ, "sequenceFrameRate");
+    if (fpsJ)
+        sequenceFrameRate = json_real_value(fpsJ);
+
+    json_t* delayJ = json_object_get(rootJ, "feedbackDelay");
+    if (delayJ)
+        feedbackDelay = rack::math::clamp((int) json_integer_value(delayJ), 1, FeedbackEffects::HISTORY_FRAMES);
+
+    json_t* fixedPointJ = json_object_get(rootJ, "fixedPointRendering");
+    if (fixedPointJ)
+        fixedPointRendering = json_boolean_value(fixedPointJ);
+
+    json_t* geometryJ = json_object_get(rootJ, "geometryMode");
+    if (geometryJ)
+        geometryMode = rack::math::clamp((int) json_integer_value(geometryJ), 0, GeometryRemap::NUM_MODES - 1);
+
+    json_t* diffusionJ = json_object_get(rootJ, "diffusionMode");
+    if (diffusionJ)
+        diffusionMode = rack::math::clamp((int) json_integer_value(diffusionJ), 0, ErrorDiffusion::NUM_MODES - 1);
+
+    json_t* downscaledJ = json_object_get(rootJ, "downscaledDisplay");
+    if (downscaledJ)
+        downscaledDisplay = json_boolean_value(downscaledJ);
+
+    json_t* adaptiveJ = json_object_get(rootJ, "adaptiveQuality");
+    if (adaptiveJ)
+        adaptiveQuality = json_boolean_value(adaptiveJ);
+
+    json_t* renderRateJ = json_object_get(rootJ, "renderRate");
+    if (renderRateJ)
+        renderRate = rack::math::clamp((float) json_number_value(renderRateJ), RENDER_RATES.front(), RENDER_RATES.back());
+
+    json_t* freeRunningJ = json_object_get(rootJ, "freeRunning");
+    if (freeRunningJ)
+        freeRunning = json_boolean_value(freeRunningJ);
+
+    json_t* scanRateJ = json_object_get(rootJ, "scanLineRate");
+    if (scanRateJ)
+        scanLineRate = rack::math::clamp((float) json_number_value(scanRateJ), SCAN_LINE_RATES.front(), SCAN_LINE_RATES.back());
+
+    json_t* scanlineJ = json_object_get(rootJ, "scanlineModulation");
+    if (scanlineJ)
+        scanlineModulation = json_boolean_value(scanlineJ);
+
+    json_t* sharedMemoryJ = json_object_get(rootJ, "sharedMemoryOutput");
+    if (sharedMemoryJ)
+        sharedMemoryOutput = json_boolean_value(sharedMemoryJ);
+
+    // Patches guardados antes de tener secuencias solo conocían GIFs
+    json_t* sourceJ = json_object_get(rootJ, "sourceType");
+    pendingSourceType = sourceJ ? static_cast<SourceType>(json_integer_value(sourceJ)) : SOURCE_GIF;
+
     // Guardar el path del GIF para cargarlo cuando el contexto esté disponible
     json_t* pathJ = json_object_get(rootJ, "imagePath");
     if (pathJ) {
         pendingGifPath = json_string_value(pathJ);
         hasPendingGif = true;
         INFO("GIFGlitcher: Path de GIF guardado para carga posterior: %s", pendingGifPath.c_str());
+    } else if (pendingSourceType == SOURCE_CHAIN) {
+        hasPendingGif = true;
     }
 }
@@ -7,7 +7,22 @@
 #include <condition_variable>
 #include <queue>
 #include <string>
+#include <memory>
+#include <array>
 #include <dsp/digital.hpp>
+#include "ImageSequence.hpp"
+#include "GifCache.hpp"
+#include "RenderScheduler.hpp"
+#include "BlurEffects.hpp"
+#include "FeedbackEffects.hpp"
+#include "MotionMosh.hpp"
+#include "FixedPointPipeline.hpp"
+#include "GeometryRemap.hpp"
+#include "ErrorDiffusion.hpp"
+#include "RenderGovernor.hpp"
+#include "FrameScanner.hpp"
+#include "ScanlineModulation.hpp"
+#include "FrameRing.hpp"
 
 using namespace rack;
 
@@ -31,6 +46,7 @@ struct ProcessingParams {
     bool invertColors{false};
     bool halfMirrorEffect{false};
     bool halfMirrorVerticalEffect{false};
+    bool fixedPoint{false};  // Render con FixedPointPipeline cuando se pueda
     float posterize{0.0f};
     float glitchArtifacts{0.0f};
     float glitchBlockSize{0.0f};
@@ -38,14 +54,38 @@ struct ProcessingParams {
     float bitCrush{0.0f};
     float dataShift{0.0f};
     float pixelSort{0.0f};
+    float blur{0.0f};
+    float bloom{0.0f};
+    float glow{0.0f};
+    float motionMosh{0.0f};
+    float feedback{0.0f};
+    float feedbackZoom{0.0f};
+    float feedbackDrift{0.0f};
+    int feedbackDelay{1};  // En frames, se elige en el menú
+    int geometryMode{0};   // GeometryRemap::Mode
+    float geometryAmount{0.0f};
+    int diffusionMode{0};  // ErrorDiffusion::Mode
+    bool scanlines{false};  // Parámetros por grupo de filas desde ScanlineModulation
 };
 
-struct GIFGlitcher : Module {
-    // Estructura para frames GIF
+// Frame buffers. A processed frame can be shared with the module on the
+// right (see ChainMessage), which renders straight from it; nobody writes
+// into a buffer someone else still holds.
+using FrameBuffer = std::shared_ptr<std::vector<unsigned char>>;
+using SharedFrame = std::shared_ptr<const std::vector<unsigned char>>;
+
+// Expander message from the module on the left: its newest processed frame
+struct ChainMessage {
+    SharedFrame frame;
+    int width{0};
+    int height{0};
+    uint64_t version{0};
+};
+
+struct GIFGlitcher : Module, RenderClient {
+    // Estructura para frames GIF; los píxeles están en decodedGif
     struct GifFrame {
-        std::vector<unsigned char> data;
         int delay;  // en milisegundos
-        int imageHandle{0};  // Añadir handle para cada frame
     };
 
     enum ParamIds {
@@ -68,6 +108,14 @@ struct GIFGlitcher : Module {
         BIT_CRUSH_PARAM,
         DATA_SHIFT_PARAM,
         PIXEL_SORT_PARAM,
+        BLUR_PARAM,
+        BLOOM_PARAM,
+        GLOW_PARAM,
+        FEEDBACK_PARAM,
+        FEEDBACK_ZOOM_PARAM,
+        FEEDBACK_DRIFT_PARAM,
+        MOTION_MOSH_PARAM,
+        GEOMETRY_PARAM,
         NUM_PARAMS
     };
     enum InputIds {
@@ -93,9 +141,19 @@ struct GIFGlitcher : Module {
         DATA_MOSH_INPUT,
         RESET_INPUT,
         RANDOM_INPUT,   // Nuevo input
+        BLUR_INPUT,
+        BLOOM_INPUT,
+        GLOW_INPUT,
+        FEEDBACK_INPUT,
+        FEEDBACK_ZOOM_INPUT,
+        FEEDBACK_DRIFT_INPUT,
+        MOTION_MOSH_INPUT,
+        GEOMETRY_INPUT,
+        SCAN_CURSOR_INPUT,
         NUM_INPUTS
     };
     enum OutputIds {
+        SCAN_OUTPUT,
         NUM_OUTPUTS
     };
     enum LightIds {
@@ -107,11 +165,16 @@ struct GIFGlitcher : Module {
 
     // Variables para GIF
     std::vector<GifFrame> gifFrames;
+    // Decoded frames, shared with every other instance showing the same file
+    std::shared_ptr<const DecodedGif> decodedGif;
     size_t currentFrame{0};
     float frameAccumulator{0.0f};
     bool isAnimated{false};
     std::mutex bufferMutex;
     bool textureNeedsUpdate{false};
+    // Bumped whenever processedData gets a new frame; written under
+    // bufferMutex, peeked at by the engine to know when to share a frame
+    std::atomic<uint64_t> processedVersion{0};
 
     // Variables existentes
     NVGcontext* vg{nullptr};
@@ -121,20 +184,26 @@ struct GIFGlitcher : Module {
     int imageHeight{0};
     std::string imagePath;
     std::vector<unsigned char> imageData;
-    std::vector<unsigned char> processedData;
+    FrameBuffer processedData{std::make_shared<std::vector<unsigned char>>()};
+    // One hash per row of processedData, empty when unknown; the display
+    // texture only gets the rows whose hash changed
+    std::vector<uint64_t> processedRowHashes;
+
+    // Mostrar una textura reducida (menos memoria y subida más rápida)
+    bool downscaledDisplay{false};
     
-    // Thread-related members
-    std::atomic<bool> threadRunning{false};
+    // Render state shared with the render threads
     std::atomic<bool> processRequested{false};
-    std::thread workerThread;
+    // Bumped by every render request; a render tagged with an older value is stale
+    std::atomic<uint64_t> renderGeneration{0};
     std::mutex paramsMutex;
-    std::condition_variable processCV;
 
     // Métodos públicos
     GIFGlitcher();
     ~GIFGlitcher() override;
     void process(const ProcessArgs& args) override;
     bool loadGif(const std::string& path);
+    bool loadImageSequence(const std::string& directory);
     void onReset() override;
     
     // Getters y setters existentes
@@ -143,16 +212,20 @@ struct GIFGlitcher : Module {
     int getImageHeight() const { return imageHeight; }
     NVGcontext* getVG() const { return vg; }
     bool isImageLoaded() const { return !imagePath.empty(); }
-    const unsigned char* getProcessedDataPtr() const { return processedData.data(); }
+    const unsigned char* getProcessedDataPtr() const { return processedData->data(); }
     const unsigned char* getImageDataPtr() const { return imageData.data(); }
 
     void setVG(NVGcontext* _vg);
 
+    // From drawLayer: (re)creates the display texture and uploads the rows
+    // that changed since the last call. Returns the texture, 0 if none.
+    int updateDisplayTexture(NVGcontext* vg);
+
     float accumulatedTime{0.0f};
-    ProcessingParams currentParams;
+    ProcessingParams currentParams;  // Último estado pedido por process()
+    uint64_t paramsVersion{0};       // Cambia con currentParams, protegido por paramsMutex
 
     void loadImage(std::string path);
-    void reloadImage();
 
     // Agregar control de velocidad
     enum PlaybackMode {
@@ -164,9 +237,38 @@ struct GIFGlitcher : Module {
     float playbackSpeed{1.0f};
     PlaybackMode playbackMode{FORWARD};
     bool playbackReverse{false};  // For ping-pong mode
-    
+    size_t nextRandomFrame{0};    // Drawn one frame ahead so it can be prefetched
+
+    // Tipo de fuente cargada, para restaurarla desde el patch
+    enum SourceType {
+        SOURCE_GIF,
+        SOURCE_IMAGE,
+        SOURCE_SEQUENCE,
+        SOURCE_CHAIN,            // Processed frames of the GIFGlitcher on the left
+        SOURCE_SHARED_MEMORY     // Frames of another process, see FrameRing.hpp
+    };
+    SourceType sourceType{SOURCE_GIF};
+
+    // Secuencia de imágenes (directorio de PNG/JPG numerados)
+    std::unique_ptr<ImageSequence> sequence;
+    float sequenceFrameRate{25.0f};
+    std::atomic<bool> lookAheadDirty{false};
+
+    bool isSequenceLoaded() const { return sequence != nullptr; }
+
+    // Render the frames of the GIFGlitcher on the left instead of a file
+    void useLeftModuleSource();
+    bool isChainSource() const { return chainSourceActive; }
+
+    // Render the newest frame of a FrameRing segment written by another
+    // process (Linux)
+    void useSharedMemorySource(const std::string& name);
+    bool isSharedMemorySource() const { return ingestActive; }
+    const std::string& getSharedMemorySourceName() const { return ingestName; }
+
     void setPlaybackSpeed(float speed) {
         playbackSpeed = speed;
+        lookAheadDirty = true;
     }
 
     float getPlaybackSpeed() const {
@@ -175,6 +277,98 @@ struct GIFGlitcher : Module {
 
     void setPlaybackMode(PlaybackMode mode) {
         playbackMode = mode;
+        lookAheadDirty = true;
+    }
+
+    void setSequenceFrameRate(float fps) {
+        sequenceFrameRate = fps;
+        lookAheadDirty = true;
+    }
+
+    float getSequenceFrameRate() const {
+        return sequenceFrameRate;
+    }
+
+    // Qué frame anterior se realimenta (1 = el último)
+    int feedbackDelay{1};
+
+    void setFeedbackDelay(int frames) {
+        feedbackDelay = frames;
+    }
+
+    int getFeedbackDelay() const {
+        return feedbackDelay;
+    }
+
+    // Render en punto fijo (más rápido, casi idéntico)
+    bool fixedPointRendering{false};
+
+    // Deformación geométrica elegida en el menú
+    int geometryMode{GeometryRemap::NONE};
+
+    void setGeometryMode(int mode) {
+        geometryMode = mode;
+    }
+
+    int getGeometryMode() const {
+        return geometryMode;
+    }
+
+    // Difusión de error en lugar de posterizar por píxel
+    int diffusionMode{ErrorDiffusion::OFF};
+
+    void setDiffusionMode(int mode) {
+        diffusionMode = mode;
+    }
+
+    int getDiffusionMode() const {
+        return diffusionMode;
+    }
+
+    // Renders per second at most; every request in between is coalesced
+    static constexpr std::array<float, 5> RENDER_RATES{{15.0f, 24.0f, 30.0f, 60.0f, 120.0f}};
+    float renderRate{60.0f};
+
+    void setRenderRate(float fps) {
+        renderRate = fps;
+    }
+
+    float getRenderRate() const {
+        return renderRate;
+    }
+
+    // Volver a renderizar a renderRate aunque no cambie nada, para que
+    // glitch slice, interlace, ruido y feedback sigan moviéndose
+    bool freeRunning{false};
+
+    // Modulación por líneas: el CV a tasa de audio cambia los parámetros
+    // a lo largo del frame en lugar de una vez por frame
+    bool scanlineModulation{false};
+
+    // Publicar cada frame procesado en memoria compartida (Linux) para
+    // otros procesos, ver FrameRing.hpp
+    bool sharedMemoryOutput{false};
+    std::string sharedMemoryName() const { return "/gifglitcher-" + std::to_string(id); }
+
+    // Líneas por segundo del escaneo en raster de la salida de CV
+    static constexpr std::array<float, 6> SCAN_LINE_RATES{{1.0f, 10.0f, 55.0f, 110.0f, 220.0f, 440.0f}};
+    float scanLineRate{110.0f};
+
+    void setScanLineRate(float rate) {
+        scanLineRate = rate;
+    }
+
+    float getScanLineRate() const {
+        return scanLineRate;
+    }
+
+    // Bajar la calidad sola cuando el render no llega a tiempo
+    bool adaptiveQuality{true};
+    RenderGovernor governor;
+
+    // Level the render and display currently work at
+    int getQualityLevel() const {
+        return adaptiveQuality ? governor.getLevel() : RenderGovernor::FULL;
     }
 
     PlaybackMode getPlaybackMode() const {
@@ -186,17 +380,139 @@ struct GIFGlitcher : Module {
     void dataFromJson(json_t* rootJ) override;
 
 private:
+    // tools/render-verify.cpp and tools/fixed-point-tolerance.cpp render
+    // scratch instances straight through renderFrame and the pre-render path
+    friend struct RenderVerifier;
+    friend struct FixedPointTolerance;
+
+    // Rows rendered between two cancellation checks
+    static constexpr int RENDER_TILE_ROWS = 16;
+    // A stale render is only finished after this many were cancelled in a row
+    static constexpr int MAX_CANCELLED_RENDERS = 2;
+    int cancelledRenders{0};
+
+    // Render budget range for animations
+    static constexpr float MIN_RENDER_BUDGET = 1.0f / 60.0f;
+    static constexpr float MAX_RENDER_BUDGET = 1.0f / 10.0f;
+    // Render rate throttling, engine thread only
+    float sinceRenderRequest{0.0f};
+    bool renderWanted{false};
+    // accumulatedTime when the render was requested, guarded by paramsMutex,
+    // and the copy the render steps use
+    float requestedClock{0.0f};
+    float renderClock{0.0f};
+
+    // Upcoming GIF frames rendered while the current one is shown
+    static constexpr size_t MAX_PRERENDERED_FRAMES = 2;
+
+    struct PrerenderedFrame {
+        size_t frame{0};
+        uint64_t paramsVersion{0};
+        bool ready{false};
+        FrameBuffer pixels;
+        std::vector<uint64_t> rowHashes;
+    };
+
+    // Guarded by bufferMutex
+    std::array<PrerenderedFrame, MAX_PRERENDERED_FRAMES> prerenderedFrames;
+    bool prerenderActive{false};
+    size_t prerenderFrame{0};
+    uint64_t prerenderVersion{0};
+    // The playhead reached the frame being pre-rendered; publish it when done
+    bool prerenderPromoted{false};
+
+    // Snapshot the render steps work with, only touched inside renderStep()
+    ProcessingParams renderParams;
+    uint64_t renderParamsVersion{0};
+    const unsigned char* renderSource{nullptr};
+    FrameBuffer prerenderBuffer;
+    std::vector<uint64_t> prerenderRowHashes;
+    // Render thread only: where prefetchFrames() last started reading
+    std::weak_ptr<const DecodedGif> prefetchedGif;
+    size_t prefetchedFrame{0};
+
+    // Display texture, only touched from the UI thread
+    static constexpr int MAX_DOWNSCALED_SIZE = 512;
+    int textureWidth{0};
+    int textureHeight{0};
+    std::vector<uint64_t> uploadedRowHashes;
+    std::vector<unsigned char> displayPixels;
+    BlurEffects blurEffects;
+    FeedbackEffects feedbackEffects;
+    MotionMosh motionMosh;
+    FixedPointPipeline fixedPointPipeline;
+    GeometryRemap geometryRemap;
+    ErrorDiffusion errorDiffusion;
+    FrameScanner frameScanner;
+    ScanlineModulation scanlineModulator;
+    // Expander chain. chainSource and its size are guarded by bufferMutex;
+    // chainMessages are this module's leftExpander buffers.
+    static constexpr size_t MAX_RETIRED_FRAMES = 8;
+    ChainMessage chainMessages[2];
+    std::atomic<bool> chainSourceActive{false};
+    SharedFrame chainSource;
+    int chainWidth{0};
+    int chainHeight{0};
+    // Engine thread only
+    uint64_t chainVersion{0};
+    const void* chainFrameSeen{nullptr};
+    bool chainWasActive{false};
+    // Handles the engine let go of, freed by the render thread so the audio
+    // thread never frees a frame; guarded by bufferMutex, never grows
+    std::vector<SharedFrame> retiredFrames;
+
+    // Shared memory source. ingestName only changes while rendering is
+    // suspended; the reader and the frame are render thread only.
+    std::atomic<bool> ingestActive{false};
+    std::string ingestName;
+    FrameRingReader ingestReader;
+    FrameRingReader::Frame ingestFrame;
+    // renderFrame reads ingestFrame in place; checked before the stateful stages
+    bool renderingIngestFrame{false};
+    // Producer frame and params of the last render from the segment
+    uint64_t ingestSequence{0};
+    uint64_t ingestParamsVersion{UINT64_MAX};
+
+    // processedVersion last stored in frameScanner, render thread only
+    uint64_t scannedVersion{UINT64_MAX};
+    // Shared memory output, render thread only
+    FrameRingWriter frameRing;
+    uint64_t publishedVersion{UINT64_MAX};
+
     // Métodos privados
-    void processImage();
-    void workerFunction();
-    void startWorkerThread();
-    void stopWorkerThread();
-    std::vector<unsigned char>& getCurrentFrameData() {
-        return gifFrames[currentFrame].data;
+    bool processImage(uint64_t generation, bool cancellable);
+    // frame is the GIF frame source comes from, if a GIF is loaded
+    bool renderFrame(const unsigned char* source, size_t frame, std::vector<unsigned char>& output,
+                     uint64_t generation, bool cancellable);
+    bool prerenderNextFrame(uint64_t generation);
+    void requestRender();
+    void requestPrerender();
+    bool renderStep() override;
+    void prefetchFrames(const std::array<size_t, MAX_PRERENDERED_FRAMES>& frames, size_t count);
+    void storeScanFrame();
+    void publishSharedFrame();
+    void sendChainFrame();
+    void receiveChainFrame();
+    bool ingestFrameReady();
+    // Stop rendering from the left module or shared memory; bufferMutex
+    // held and rendering suspended
+    void leaveLiveSource();
+    void resumeRendering();
+    void suspendRendering();
+    void installImage(const unsigned char* pixels, int width, int height);
+    size_t stepFrame(size_t frame, bool& reverse) const;
+    void updateLookAhead();
+    // Helpers for prerenderedFrames; bufferMutex must be held
+    size_t upcomingFrames(std::array<size_t, MAX_PRERENDERED_FRAMES>& frames) const;
+    bool takePrerenderedFrame(size_t frame);
+    void clearPrerenderedFrames();
+    const unsigned char* getCurrentFrameData() const {
+        return decodedGif->frames[currentFrame].pixels;
     }
     // Variable para almacenar el path pendiente de cargar
     std::string pendingGifPath;
     bool hasPendingGif = false;
+    SourceType pendingSourceType = SOURCE_GIF;
 
     // Estructura interna para el procesamiento de píxeles
     struct PixelInfo {
@@ -205,15 +521,23 @@ private:
         bool processed = false;
     };
 
+    // Kernels specialised on effect flags; renderFrame picks one per frame
+    using SourceRowKernel = void (GIFGlitcher::*)(std::vector<PixelInfo>&, int);
+    using RowKernel = void (GIFGlitcher::*)(std::vector<PixelInfo>&, int);
+    using OutputRowKernel = void (GIFGlitcher::*)(const std::vector<PixelInfo>&, int, unsigned char*);
+    template <bool Mirror, bool HalfMirror>
+    void loadSourceRow(std::vector<PixelInfo>& pixelBuffer, int y);
+    template <bool Dither, bool Posterize>
+    void applyPosterizeAndDither(std::vector<PixelInfo>& pixelBuffer, int y);
+    template <bool Interlace, bool Noise, bool Invert>
+    void storeOutputRow(const std::vector<PixelInfo>& pixelBuffer, int y, unsigned char* output);
+
     // Funciones de procesamiento de efectos
-    void applyGeometricEffects(PixelInfo& pixel, int x, int y);
     void applyPixelation(std::vector<PixelInfo>& pixelBuffer, int y);
     void applyRgbAberration(std::vector<PixelInfo>& pixelBuffer, int y);
     void applyColorAdjustments(std::vector<PixelInfo>& pixelBuffer);
     void applyKernelEffects(std::vector<PixelInfo>& pixelBuffer, int y);
     void applyGlitchEffects(std::vector<PixelInfo>& pixelBuffer, int y);
-    void applyPosterizeAndDither(std::vector<PixelInfo>& pixelBuffer, int y);
-    void applyPostProcessingEffects(PixelInfo& pixel, int x, int y);
     void applyDataMoshEffects(std::vector<PixelInfo>& pixelBuffer, int y);
 };
 
@@ -0,0 +1,138 @@
+#include "GeometryRemap.hpp"
+#include "RenderScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Gather tiles: a tile of rotated or zoomed output reads a compact patch of
+// the source, which stays in cache for the whole tile
+const int TILE_ROWS = 16;
+const int TILE_COLUMNS = 64;
+
+const float TWO_PI = 2.0f * static_cast<float>(M_PI);
+
+int tileCount(int size, int tile) {
+    return (size + tile - 1) / tile;
+}
+
+// Sample positions outside the frame wrap around
+int wrap(float position, int size) {
+    int index = static_cast<int>(std::floor(position + 0.5f)) % size;
+    return index < 0 ? index + size : index;
+}
+
+} // end anonymous namespace
+
+const unsigned char* GeometryRemap::apply(const unsigned char* source, int frameWidth, int frameHeight,
+                                          int mode, float amount) {
+    if (mode <= NONE || mode >= NUM_MODES) return source;
+
+    if (frameWidth != width || frameHeight != height || mode != tableMode || amount != tableAmount) {
+        width = frameWidth;
+        height = frameHeight;
+        buildTable(mode, amount);
+        tableMode = mode;
+        tableAmount = amount;
+    }
+
+    warped.resize(static_cast<size_t>(width) * height * 4);
+    const int columnTiles = tileCount(width, TILE_COLUMNS);
+    RenderScheduler::instance().parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+        int endY = std::min(height, (tile + 1) * TILE_ROWS);
+        for (int column = 0; column < columnTiles; column++) {
+            int startX = column * TILE_COLUMNS;
+            int endX = std::min(width, startX + TILE_COLUMNS);
+            for (int y = tile * TILE_ROWS; y < endY; y++) {
+                const uint32_t* indices = table.data() + static_cast<size_t>(y) * width;
+                unsigned char* out = warped.data() + static_cast<size_t>(y) * width * 4;
+                for (int x = startX; x < endX; x++) {
+                    std::memcpy(out + x * 4, source + static_cast<size_t>(indices[x]) * 4, 4);
+                }
+            }
+        }
+    });
+    return warped.data();
+}
+
+void GeometryRemap::buildTable(int mode, float amount) {
+    table.resize(static_cast<size_t>(width) * height);
+
+    const float centerX = (width - 1) * 0.5f;
+    const float centerY = (height - 1) * 0.5f;
+    const float longSide = static_cast<float>(std::max(width, height));
+    const float maxRadius = std::sqrt(centerX * centerX + centerY * centerY);
+
+    // Per-mode constants
+    const float angle = amount * TWO_PI;
+    const float cosAngle = std::cos(angle);
+    const float sinAngle = std::sin(angle);
+    const float zoom = 1.0f + amount * 3.0f;
+    const int segments = 2 + static_cast<int>(std::round(amount * 10.0f));
+    const float segmentAngle = TWO_PI / segments;
+    const int tiles = 1 + static_cast<int>(std::round(amount * 7.0f));
+    const float waveHeight = amount * 0.05f * longSide;
+    const float waveLength = longSide / 4.0f;
+
+    RenderScheduler::instance().parallelFor(tileCount(height, TILE_ROWS), [&](int tile) {
+        int endY = std::min(height, (tile + 1) * TILE_ROWS);
+        for (int y = tile * TILE_ROWS; y < endY; y++) {
+            uint32_t* row = table.data() + static_cast<size_t>(y) * width;
+            const float dy = y - centerY;
+
+            for (int x = 0; x < width; x++) {
+                const float dx = x - centerX;
+                float sourceX = static_cast<float>(x);
+                float sourceY = static_cast<float>(y);
+
+                switch (mode) {
+                    case ROTATE:
+                        // Output rotated by angle: sample the inverse rotation
+                        sourceX = centerX + dx * cosAngle + dy * sinAngle;
+                        sourceY = centerY - dx * sinAngle + dy * cosAngle;
+                        break;
+                    case ZOOM:
+                        sourceX = centerX + dx / zoom;
+                        sourceY = centerY + dy / zoom;
+                        break;
+                    case KALEIDOSCOPE: {
+                        // Fold every wedge onto the first one, mirrored every other wedge
+                        float radius = std::sqrt(dx * dx + dy * dy);
+                        float theta = std::atan2(dy, dx) + TWO_PI;
+                        int wedge = static_cast<int>(theta / segmentAngle);
+                        float folded = theta - wedge * segmentAngle;
+                        if (wedge % 2) {
+                            folded = segmentAngle - folded;
+                        }
+                        sourceX = centerX + radius * std::cos(folded);
+                        sourceY = centerY + radius * std::sin(folded);
+                        break;
+                    }
+                    case TILE:
+                        sourceX = static_cast<float>(x * tiles);
+                        sourceY = static_cast<float>(y * tiles);
+                        break;
+                    case POLAR: {
+                        // Angle around the centre across, distance from it down,
+                        // mixed with the plain frame by amount
+                        float theta = std::atan2(dy, dx) + static_cast<float>(M_PI);
+                        float polarX = theta / TWO_PI * width;
+                        float polarY = std::sqrt(dx * dx + dy * dy) / maxRadius * height;
+                        sourceX = x + (polarX - x) * amount;
+                        sourceY = y + (polarY - y) * amount;
+                        break;
+                    }
+                    case WAVE:
+                        sourceX = x + waveHeight * std::sin(TWO_PI * y / waveLength);
+                        sourceY = y + waveHeight * std::sin(TWO_PI * x / waveLength);
+                        break;
+                    default:
+                        break;
+                }
+
+                row[x] = static_cast<uint32_t>(wrap(sourceY, height)) * width + wrap(sourceX, width);
+            }
+        }
+    });
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <cstdint>
+
+using namespace rack;
+
+// Geometric warps of the source frame through a remap table: for every
+// output pixel the table holds the index of the source pixel it shows. The
+// table is only rebuilt when the mode, amount or size changes, so any warp
+// costs one gather per frame, the same as a plain copy.
+struct GeometryRemap {
+    enum Mode {
+        NONE,
+        ROTATE,
+        ZOOM,
+        KALEIDOSCOPE,
+        TILE,
+        POLAR,
+        WAVE,
+        NUM_MODES
+    };
+
+    // Returns the warped frame, or source itself for NONE. amount in 0..1
+    // sets the angle, zoom, segment or tile count, polar mix or wave height.
+    const unsigned char* apply(const unsigned char* source, int width, int height, int mode, float amount);
+
+private:
+    std::vector<uint32_t> table;
+    std::vector<unsigned char> warped;
+    int tableMode{NONE};
+    float tableAmount{-1.0f};
+    int width{0};
+    int height{0};
+
+    void buildTable(int mode, float amount);
+};
@@ -0,0 +1,407 @@
+#include "GifCache.hpp"
+#include "MappedFile.hpp"
+#include "SimdKernels.hpp"
+#include "gif_lib.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace {
+
+// giflib input callback serving bytes straight from a mapped file
+struct GifMemoryReader {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+};
+
+int readGifFromMemory(GifFileType* gif, GifByteType* buffer, int length) {
+    GifMemoryReader* reader = static_cast<GifMemoryReader*>(gif->UserData);
+    size_t count = std::min(reader->size - reader->position, static_cast<size_t>(std::max(length, 0)));
+    std::memcpy(buffer, reader->data + reader->position, count);
+    reader->position += count;
+    return static_cast<int>(count);
+}
+
+// An edited or replaced file gets a new key and is decoded again
+struct CacheKey {
+    std::string path;
+    size_t size;
+    int64_t modifiedTime;
+
+    bool operator<(const CacheKey& other) const {
+        return std::tie(path, size, modifiedTime) < std::tie(other.path, other.size, other.modifiedTime);
+    }
+};
+
+using GifPtr = std::shared_ptr<const DecodedGif>;
+
+std::mutex cacheMutex;
+// Weak references: the instances holding a GIF keep it alive, not the cache
+std::map<CacheKey, std::weak_ptr<const DecodedGif>> cache;
+// Decodes in progress, so a patch with several instances on one file decodes it once
+std::map<CacheKey, std::shared_future<GifPtr>> pending;
+
+std::shared_ptr<DecodedGif> decodeGif(const std::string& path, const MappedFile& file) {
+    int error;
+    GifMemoryReader reader{file.data(), file.size(), 0};
+    GifFileType* gif = DGifOpen(&reader, readGifFromMemory, &error);
+    if (!gif) {
+        INFO("GIFGlitcher: Error al abrir archivo GIF: %s (error %d)", path.c_str(), error);
+        return nullptr;
+    }
+
+    if (DGifSlurp(gif) != GIF_OK) {
+        INFO("GIFGlitcher: Error al leer contenido del GIF: %s (error %d)", path.c_str(), gif->Error);
+        DGifCloseFile(gif, &error);
+        return nullptr;
+    }
+
+    // Verificar dimensiones del GIF
+    if (gif->SWidth <= 0 || gif->SHeight <= 0 || gif->SWidth > 4096 || gif->SHeight > 4096) {
+        INFO("GIFGlitcher: Dimensiones de GIF inválidas: %dx%d", gif->SWidth, gif->SHeight);
+        DGifCloseFile(gif, &error);
+        return nullptr;
+    }
+
+    INFO("GIFGlitcher: Dimensiones del GIF: %dx%d, %d frames",
+         gif->SWidth, gif->SHeight, gif->ImageCount);
+
+    // Verificar si hay frames
+    if (gif->ImageCount <= 0) {
+        INFO("GIFGlitcher: El GIF no tiene frames");
+        DGifCloseFile(gif, &error);
+        return nullptr;
+    }
+
+    auto decoded = std::make_shared<DecodedGif>();
+    decoded->width = gif->SWidth;
+    decoded->height = gif->SHeight;
+    decoded->frames.reserve(gif->ImageCount);
+    // One block for all frames, laid out like the frame cache file
+    decoded->storage.resize(decoded->frameSize() * gif->ImageCount);
+
+    const int imageWidth = decoded->width;
+    std::vector<unsigned char> canvas(imageWidth * decoded->height * 4, 0);
+    std::vector<unsigned char> prevCanvas(imageWidth * decoded->height * 4, 0);
+
+    // Convert each frame
+    for (int i = 0; i < gif->ImageCount; i++) {
+        SavedImage* image = &gif->SavedImages[i];
+        DecodedGif::Frame frame;
+
+        int transparentColor = -1;
+        int disposal = 0;
+        for (int j = 0; j < image->ExtensionBlockCount; j++) {
+            ExtensionBlock* eb = &image->ExtensionBlocks[j];
+            if (eb->Function == GRAPHICS_EXT_FUNC_CODE) {
+                disposal = (eb->Bytes[0] >> 2) & 7;
+                if (eb->Bytes[0] & 0x01)
+                    transparentColor = (int)eb->Bytes[3];
+            }
+        }
+
+        ColorMapObject* colorMap = image->ImageDesc.ColorMap ? image->ImageDesc.ColorMap : gif->SColorMap;
+
+        // Damaged files can place a frame outside the logical screen or omit
+        // the palette; such a frame leaves the canvas as it is
+        const GifImageDesc& desc = image->ImageDesc;
+        bool drawable = colorMap && desc.Left >= 0 && desc.Top >= 0
+                        && desc.Left + desc.Width <= imageWidth && desc.Top + desc.Height <= decoded->height;
+
+        if (i > 0 && drawable) {
+            if (disposal == DISPOSE_BACKGROUND) {
+                for (int y = 0; y < image->ImageDesc.Height; y++) {
+                    for (int x = 0; x < image->ImageDesc.Width; x++) {
+                        int idx = ((y + image->ImageDesc.Top) * imageWidth + (x + image->ImageDesc.Left)) * 4;
+                        canvas[idx] = 0;
+                        canvas[idx + 1] = 0;
+                        canvas[idx + 2] = 0;
+                        canvas[idx + 3] = 0;
+                    }
+                }
+            } else if (disposal == DISPOSE_PREVIOUS) {
+                canvas = prevCanvas;
+            }
+        }
+        prevCanvas = canvas;
+
+        if (drawable) {
+            // RGBA per index; the transparent index and indices past the
+            // palette get alpha 0 and leave the canvas as it is
+            uint32_t palette[256] = {};
+            for (int c = 0; c < std::min(colorMap->ColorCount, 256); c++) {
+                if (c == transparentColor) continue;
+                const GifColorType& color = colorMap->Colors[c];
+                const unsigned char rgba[4] = {color.Red, color.Green, color.Blue, 255};
+                std::memcpy(&palette[c], rgba, 4);
+            }
+
+            const SimdKernels& kernels = simdKernels();
+            for (int y = 0; y < desc.Height; y++) {
+                kernels.expandPalette(image->RasterBits + static_cast<size_t>(y) * desc.Width, palette,
+                                      canvas.data() + (static_cast<size_t>(y + desc.Top) * imageWidth + desc.Left) * 4,
+                                      desc.Width);
+            }
+        }
+
+        unsigned char* pixels = decoded->storage.data() + decoded->frameSize() * i;
+        std::memcpy(pixels, canvas.data(), canvas.size());
+        frame.pixels = pixels;
+        frame.delay = 100; // Default delay
+        for (int j = 0; j < image->ExtensionBlockCount; j++) {
+            ExtensionBlock* eb = &image->ExtensionBlocks[j];
+            if (eb->Function == GRAPHICS_EXT_FUNC_CODE) {
+                int delay = ((eb->Bytes[2] << 8) | eb->Bytes[1]) * 10;
+                if (delay > 0) {
+                    frame.delay = delay;
+                }
+                break;
+            }
+        }
+
+        decoded->frames.push_back(std::move(frame));
+    }
+
+    DGifCloseFile(gif, &error);
+    return decoded;
+}
+
+// --- Frame cache file ---
+// Header, frame delays, then the RGBA frames back to back starting at a page
+// boundary, so the file can be mapped and used as DecodedGif storage as is.
+const char FRAME_CACHE_MAGIC[8] = {'G', 'G', 'F', 'C', 'A', 'C', 'H', 'E'};
+const uint32_t FRAME_CACHE_VERSION = 1;
+const uint64_t FRAME_CACHE_ALIGNMENT = 4096;
+// Larger GIFs are decoded every time rather than filling the disk
+const uint64_t MAX_FRAME_CACHE_FILE_SIZE = 1ull << 30;
+// The cache folder is emptied when a new file would take it over this
+const uint64_t MAX_FRAME_CACHE_TOTAL_SIZE = 4ull << 30;
+
+struct FrameCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t frameCount;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    int32_t width;
+    int32_t height;
+    uint64_t framesOffset;
+};
+
+// FNV-1a over the whole GIF: the cache stays valid when the file is copied
+// or touched, and is ignored as soon as its contents change
+uint64_t hashFile(const MappedFile& file) {
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* data = file.data();
+    for (size_t i = 0; i < file.size(); i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string frameCacheDirectory() {
+    return asset::user("GIFGlitcher/cache");
+}
+
+std::string frameCachePath(uint64_t sourceHash) {
+    return system::join(frameCacheDirectory(), string::f("%016llx.gfc", static_cast<unsigned long long>(sourceHash)));
+}
+
+uint64_t framesOffset(uint32_t frameCount) {
+    uint64_t offset = sizeof(FrameCacheHeader) + sizeof(int32_t) * frameCount;
+    return (offset + FRAME_CACHE_ALIGNMENT - 1) / FRAME_CACHE_ALIGNMENT * FRAME_CACHE_ALIGNMENT;
+}
+
+std::shared_ptr<DecodedGif> loadFrameCache(const std::string& cachePath, const MappedFile& source, uint64_t sourceHash) {
+    auto decoded = std::make_shared<DecodedGif>();
+    MappedFile& mapping = decoded->mapping;
+    if (!mapping.open(cachePath, MappedFile::LOOPED) || mapping.size() < sizeof(FrameCacheHeader)) {
+        return nullptr;
+    }
+
+    FrameCacheHeader header;
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (std::memcmp(header.magic, FRAME_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != FRAME_CACHE_VERSION
+        || header.sourceHash != sourceHash
+        || header.sourceSize != source.size()
+        || header.width <= 0 || header.height <= 0 || header.width > 4096 || header.height > 4096
+        || header.frameCount == 0
+        || header.framesOffset != framesOffset(header.frameCount)) {
+        return nullptr;
+    }
+
+    decoded->width = header.width;
+    decoded->height = header.height;
+    if (mapping.size() < header.framesOffset + decoded->frameSize() * header.frameCount) {
+        return nullptr;
+    }
+
+    // Only the header and delays are read here; frame pages load on first use
+    const unsigned char* delays = mapping.data() + sizeof(FrameCacheHeader);
+    decoded->frames.resize(header.frameCount);
+    for (uint32_t i = 0; i < header.frameCount; i++) {
+        int32_t delay;
+        std::memcpy(&delay, delays + sizeof(int32_t) * i, sizeof(delay));
+        // The decoder never writes a delay below 1 ms; anything else is a
+        // stale or damaged file, and would stall or spin the playback timer
+        if (delay <= 0) {
+            return nullptr;
+        }
+        decoded->frames[i].delay = delay;
+        decoded->frames[i].pixels = mapping.data() + header.framesOffset + decoded->frameSize() * i;
+    }
+    return decoded;
+}
+
+// Remove every cache file; called when the folder grows past its budget
+void clearFrameCache() {
+    for (const std::string& entry : system::getEntries(frameCacheDirectory())) {
+        if (system::getExtension(entry) == ".gfc") {
+            system::remove(entry);
+        }
+    }
+}
+
+void saveFrameCache(const std::string& cachePath, const DecodedGif& decoded, const MappedFile& source, uint64_t sourceHash) {
+    uint32_t frameCount = static_cast<uint32_t>(decoded.frames.size());
+    uint64_t offset = framesOffset(frameCount);
+    uint64_t fileSize = offset + decoded.frameSize() * frameCount;
+    if (fileSize > MAX_FRAME_CACHE_FILE_SIZE) {
+        return;
+    }
+
+    system::createDirectories(frameCacheDirectory());
+    uint64_t totalSize = 0;
+    for (const std::string& entry : system::getEntries(frameCacheDirectory())) {
+        totalSize += system::getFileSize(entry);
+    }
+    if (totalSize + fileSize > MAX_FRAME_CACHE_TOTAL_SIZE) {
+        clearFrameCache();
+    }
+
+    FrameCacheHeader header{};
+    std::memcpy(header.magic, FRAME_CACHE_MAGIC, sizeof(header.magic));
+    header.version = FRAME_CACHE_VERSION;
+    header.frameCount = frameCount;
+    header.sourceHash = sourceHash;
+    header.sourceSize = source.size();
+    header.width = decoded.width;
+    header.height = decoded.height;
+    header.framesOffset = offset;
+
+    std::vector<int32_t> delays;
+    for (const DecodedGif::Frame& frame : decoded.frames) {
+        delays.push_back(frame.delay);
+    }
+    std::vector<unsigned char> padding(offset - sizeof(header) - sizeof(int32_t) * frameCount, 0);
+
+    // Written under a temporary name so a crash never leaves a truncated cache
+    std::string tempPath = cachePath + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                   && std::fwrite(delays.data(), sizeof(int32_t), delays.size(), file) == delays.size()
+                   && std::fwrite(padding.data(), 1, padding.size(), file) == padding.size();
+    for (const DecodedGif::Frame& frame : decoded.frames) {
+        written = written && std::fwrite(frame.pixels, 1, decoded.frameSize(), file) == decoded.frameSize();
+    }
+    written = std::fclose(file) == 0 && written;
+
+    if (!written) {
+        INFO("GIFGlitcher: No se pudo escribir la caché de frames: %s", cachePath.c_str());
+        system::remove(tempPath);
+        return;
+    }
+    // A stale cache of the same name may be in the way on Windows
+    system::remove(cachePath);
+    system::rename(tempPath, cachePath);
+}
+
+} // end anonymous namespace
+
+namespace GifCache {
+
+std::shared_ptr<const DecodedGif> acquire(const std::string& path) {
+    // Mapear el archivo y decodificar desde memoria, sin un read() por bloque
+    MappedFile file;
+    if (!file.open(path)) {
+        INFO("GIFGlitcher: Error al mapear archivo GIF: %s", path.c_str());
+        return nullptr;
+    }
+
+    CacheKey key{path, file.size(), file.modifiedTime()};
+    std::promise<GifPtr> promise;
+    std::shared_future<GifPtr> inProgress;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto cached = cache.find(key);
+        if (cached != cache.end()) {
+            if (GifPtr gif = cached->second.lock()) {
+                INFO("GIFGlitcher: GIF compartido desde la caché: %s", path.c_str());
+                return gif;
+            }
+            cache.erase(cached);
+        }
+
+        auto decoding = pending.find(key);
+        if (decoding != pending.end()) {
+            inProgress = decoding->second;
+        } else {
+            pending.emplace(key, promise.get_future().share());
+        }
+    }
+
+    // Another instance is decoding this file right now, wait for its result
+    if (inProgress.valid()) {
+        return inProgress.get();
+    }
+
+    GifPtr gif;
+    try {
+        // A GIF opened before is mapped from the frame cache, no decode
+        uint64_t sourceHash = hashFile(file);
+        std::string cachePath = frameCachePath(sourceHash);
+        std::shared_ptr<DecodedGif> decoded = loadFrameCache(cachePath, file, sourceHash);
+        if (decoded) {
+            INFO("GIFGlitcher: Frames mapeados desde la caché: %s", cachePath.c_str());
+        } else {
+            decoded = decodeGif(path, file);
+            if (decoded) {
+                saveFrameCache(cachePath, *decoded, file, sourceHash);
+            }
+        }
+        gif = decoded;
+    } catch (const std::exception& e) {
+        INFO("GIFGlitcher: Error al decodificar GIF: %s (%s)", path.c_str(), e.what());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        pending.erase(key);
+        if (gif) {
+            cache[key] = gif;
+        }
+
+        // Forget files no instance shows anymore
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->second.expired()) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    promise.set_value(gif);
+    return gif;
+}
+
+} // namespace GifCache
@@ -0,0 +1,47 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <string>
+#include <memory>
+#include "MappedFile.hpp"
+
+using namespace rack;
+
+// Fully composited RGBA frames of one GIF file. Immutable once decoded, so
+// every module instance showing the same file can read the same copy.
+struct DecodedGif {
+    struct Frame {
+        const unsigned char* pixels;  // width * height * 4 bytes
+        int delay;  // en milisegundos
+    };
+
+    int width{0};
+    int height{0};
+    std::vector<Frame> frames;
+
+    size_t frameSize() const { return static_cast<size_t>(width) * height * 4; }
+
+    // Start paging in a frame of a mapped cache file before it is shown;
+    // nothing to do for frames decoded in memory
+    void prefetch(size_t frame) const {
+        mapping.prefetch(frames[frame].pixels, frameSize());
+    }
+
+    // Backing store of the frame pixels: decoded in memory, or a mapped
+    // frame cache file that the render thread pages in ahead of the playhead
+    std::vector<unsigned char> storage;
+    MappedFile mapping;
+};
+
+// Process-wide cache of decoded GIFs, keyed by path, file size and
+// modification time. Entries live as long as some instance holds them.
+// Decoded frames are also kept on disk in the user folder, so the next
+// time a file is opened its frames are mapped instead of decoded.
+namespace GifCache {
+
+// Decoded frames of the GIF at path, decoding it only if no instance holds
+// it already. Concurrent requests for the same file share a single decode.
+// Returns null if the file cannot be read or decoded.
+std::shared_ptr<const DecodedGif> acquire(const std::string& path);
+
+} // namespace GifCache
@@ -0,0 +1,213 @@
+#include "ImageSequence.hpp"
+#include "MappedFile.hpp"
+#include "stb_image.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+ImageSequence::ImageSequence(std::vector<std::string> framePaths, int width, int height)
+    : paths(std::move(framePaths)), width(width), height(height) {
+    for (int i = 0; i < NUM_PREFETCH_THREADS; i++) {
+        threads.emplace_back(&ImageSequence::prefetchWorker, this);
+    }
+}
+
+ImageSequence::~ImageSequence() {
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        running = false;
+    }
+    slotsCV.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool ImageSequence::decode(size_t frame, std::vector<unsigned char>& pixels) const {
+    if (frame >= paths.size()) return false;
+
+    int frameWidth, frameHeight;
+    return decodeFile(paths[frame], pixels, frameWidth, frameHeight)
+        && frameWidth == width && frameHeight == height;
+}
+
+bool ImageSequence::decodeFile(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height) {
+    MappedFile file;
+    if (!file.open(path) || file.size() > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+
+    int channels;
+    unsigned char* data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                &width, &height, &channels, 4);
+    if (!data) {
+        return false;
+    }
+
+    // Reuses the capacity of a recycled buffer, no allocation per frame
+    pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+void ImageSequence::setLookAhead(const LookAhead& lookAhead) {
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        wanted = lookAhead;
+
+        // Release slots holding frames that are no longer coming up
+        for (auto& slot : slots) {
+            if (slot.state == SLOT_FREE || isWanted(slot.frame)) {
+                slot.stale = false;
+                continue;
+            }
+            if (slot.state == SLOT_DECODING) {
+                slot.stale = true;
+            } else {
+                slot.state = SLOT_FREE;
+            }
+        }
+        assignSlots();
+    }
+    slotsCV.notify_all();
+}
+
+bool ImageSequence::take(size_t frame, std::vector<unsigned char>& pixels) {
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        Slot* slot = findSlot(frame);
+        if (!slot || slot->state != SLOT_READY) {
+            return false;
+        }
+
+        pixels.swap(slot->pixels);
+        slot->state = SLOT_FREE;
+        assignSlots();
+    }
+    slotsCV.notify_all();
+    return true;
+}
+
+std::vector<std::string> ImageSequence::findFrames(const std::string& directory) {
+    struct Entry {
+        std::string prefix;
+        long long number;
+        std::string path;
+    };
+
+    std::vector<Entry> entries;
+    for (const std::string& path : system::getEntries(directory)) {
+        if (!system::isFile(path)) continue;
+
+        std::string extension = string::lowercase(system::getExtension(path));
+        if (extension != ".png" && extension != ".jpg" && extension != ".jpeg") continue;
+
+        // "loop_0012.png" sorts as ("loop_", 12) so unpadded numbers keep their order
+        std::string stem = system::getStem(path);
+        size_t digits = stem.size();
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(stem[digits - 1]))) {
+            digits--;
+        }
+        std::string number = stem.substr(digits, 18);
+        entries.push_back({stem.substr(0, digits), number.empty() ? -1 : std::stoll(number), path});
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.prefix != b.prefix) return a.prefix < b.prefix;
+        if (a.number != b.number) return a.number < b.number;
+        return a.path < b.path;
+    });
+
+    std::vector<std::string> paths;
+    paths.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        paths.push_back(entry.path);
+    }
+    return paths;
+}
+
+void ImageSequence::prefetchWorker() {
+    std::vector<unsigned char> buffer;
+
+    while (true) {
+        Slot* slot;
+        size_t frame;
+        {
+            std::unique_lock<std::mutex> lock(slotsMutex);
+            slotsCV.wait(lock, [this] {
+                return !running || nextQueuedSlot();
+            });
+            if (!running) break;
+
+            slot = nextQueuedSlot();
+            slot->state = SLOT_DECODING;
+            frame = slot->frame;
+            // Decode into the slot's old buffer without holding the lock
+            buffer.swap(slot->pixels);
+        }
+
+        if (!decode(frame, buffer)) {
+            // Keep playback going with a black frame rather than stalling on it
+            WARN("GIFGlitcher: Could not decode sequence frame %s", paths[frame].c_str());
+            buffer.assign(static_cast<size_t>(width) * height * 4, 0);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex);
+            slot->pixels.swap(buffer);
+            if (slot->stale) {
+                slot->stale = false;
+                slot->state = SLOT_FREE;
+                assignSlots();
+            } else {
+                slot->state = SLOT_READY;
+            }
+        }
+        slotsCV.notify_all();
+    }
+}
+
+void ImageSequence::assignSlots() {
+    for (size_t i = 0; i < wanted.count; i++) {
+        size_t frame = wanted.frames[i];
+        if (frame >= paths.size() || findSlot(frame)) continue;
+
+        auto freeSlot = std::find_if(slots.begin(), slots.end(), [](const Slot& slot) {
+            return slot.state == SLOT_FREE;
+        });
+        if (freeSlot == slots.end()) break;
+
+        freeSlot->state = SLOT_QUEUED;
+        freeSlot->frame = frame;
+        freeSlot->stale = false;
+    }
+}
+
+ImageSequence::Slot* ImageSequence::findSlot(size_t frame) {
+    for (auto& slot : slots) {
+        if (slot.state != SLOT_FREE && !slot.stale && slot.frame == frame) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+ImageSequence::Slot* ImageSequence::nextQueuedSlot() {
+    // Decode in the order the frames will be shown
+    for (size_t i = 0; i < wanted.count; i++) {
+        for (auto& slot : slots) {
+            if (slot.state == SLOT_QUEUED && slot.frame == wanted.frames[i]) {
+                return &slot;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool ImageSequence::isWanted(size_t frame) const {
+    return std::find(wanted.frames.begin(), wanted.frames.begin() + wanted.count, frame)
+           != wanted.frames.begin() + wanted.count;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <array>
+
+using namespace rack;
+
+// Numbered stills played back as an animation. Frames are decoded on a small
+// pool of prefetch threads into a bounded ring of slots, so only the frames
+// about to be shown are held in memory.
+struct ImageSequence {
+    static constexpr size_t MAX_LOOK_AHEAD = 8;
+    static constexpr int NUM_PREFETCH_THREADS = 2;
+
+    // Upcoming frame indices in the order they will be shown
+    struct LookAhead {
+        std::array<size_t, MAX_LOOK_AHEAD> frames;
+        size_t count{0};
+
+        void push(size_t frame) {
+            if (count < frames.size()) frames[count++] = frame;
+        }
+    };
+
+    ImageSequence(std::vector<std::string> framePaths, int width, int height);
+    ~ImageSequence();
+
+    size_t size() const { return paths.size(); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Decode one frame on the calling thread. Fails if the file does not
+    // match the sequence dimensions.
+    bool decode(size_t frame, std::vector<unsigned char>& pixels) const;
+
+    // Decode any still to RGBA through a memory-mapped file
+    static bool decodeFile(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height);
+
+    // Replace the set of frames the prefetch threads should have ready.
+    // Never blocks on a decode, safe to call from the engine thread.
+    void setLookAhead(const LookAhead& lookAhead);
+
+    // Swap a prefetched frame into pixels if it is ready. The previous
+    // contents of pixels are kept as the slot's buffer for the next decode.
+    bool take(size_t frame, std::vector<unsigned char>& pixels);
+
+    // Collect the numbered stills of a directory in playback order
+    static std::vector<std::string> findFrames(const std::string& directory);
+
+private:
+    enum SlotState {
+        SLOT_FREE,
+        SLOT_QUEUED,
+        SLOT_DECODING,
+        SLOT_READY
+    };
+
+    struct Slot {
+        SlotState state{SLOT_FREE};
+        size_t frame{0};
+        // Set when the frame left the look-ahead while it was being decoded
+        bool stale{false};
+        std::vector<unsigned char> pixels;
+    };
+
+    std::vector<std::string> paths;
+    int width;
+    int height;
+
+    std::array<Slot, MAX_LOOK_AHEAD> slots;
+    LookAhead wanted;
+    std::mutex slotsMutex;
+    std::condition_variable slotsCV;
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+
+    void prefetchWorker();
+    // Queue wanted frames into free slots; slotsMutex must be held
+    void assignSlots();
+    Slot* findSlot(size_t frame);
+    Slot* nextQueuedSlot();
+    bool isWanted(size_t frame) const;
+};
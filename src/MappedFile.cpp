@@ -0,0 +1,133 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+
+#if defined ARCH_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, Access access) {
+    close();
+
+#if defined ARCH_WIN
+    std::wstring pathW = string::UTF8toUTF16(path);
+    DWORD flags = access == SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    HANDLE file = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, flags, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    FILETIME writeTime;
+    if (!GetFileTime(file, NULL, NULL, &writeTime)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mapData = static_cast<const unsigned char*>(view);
+    mapSize = static_cast<size_t>(fileSize.QuadPart);
+    mapModifiedTime = (static_cast<int64_t>(writeTime.dwHighDateTime) << 32) | writeTime.dwLowDateTime;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    // Decoders read front to back. Looped reads keep the default: sequential
+    // would drop pages behind the reader that the next loop wants again.
+    if (access == SEQUENTIAL) {
+        madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    }
+
+    mapData = static_cast<const unsigned char*>(view);
+    mapSize = static_cast<size_t>(st.st_size);
+#if defined ARCH_MAC
+    mapModifiedTime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    mapModifiedTime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
+void MappedFile::prefetch(const unsigned char* start, size_t length) const {
+    if (!mapData || start < mapData || start >= mapData + mapSize) {
+        return;
+    }
+    length = std::min(length, static_cast<size_t>(mapData + mapSize - start));
+
+#if defined ARCH_WIN
+    // Touch a byte of every page; PrefetchVirtualMemory needs Windows 8
+    volatile unsigned char sink = 0;
+    for (size_t offset = 0; offset < length; offset += 4096) {
+        sink = sink + start[offset];
+    }
+#else
+    // madvise wants a page aligned start; the readahead runs in the background
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t first = reinterpret_cast<uintptr_t>(start) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(start) + length;
+    madvise(reinterpret_cast<void*>(first), end - first, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::close() {
+    if (!mapData) {
+        return;
+    }
+
+#if defined ARCH_WIN
+    UnmapViewOfFile(mapData);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(mapData), mapSize);
+#endif
+    mapData = nullptr;
+    mapSize = 0;
+    mapModifiedTime = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <rack.hpp>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+using namespace rack;
+
+// Read-only view of a whole file. The file is memory-mapped, so decoders can
+// parse it in place without a read() per block and without an extra copy.
+struct MappedFile {
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // How the file will be read: decoders go through it front to back once,
+    // frame caches are read wherever the playhead is, loop after loop
+    enum Access { SEQUENTIAL, LOOPED };
+
+    bool open(const std::string& path, Access access = SEQUENTIAL);
+    void close();
+
+    // Start reading [start, start + length) in ahead of its use, so a later
+    // read does not wait on the disk. Not for the engine thread: on some
+    // platforms this touches the pages itself.
+    void prefetch(const unsigned char* start, size_t length) const;
+
+    bool isOpen() const { return mapData != nullptr; }
+    const unsigned char* data() const { return mapData; }
+    size_t size() const { return mapSize; }
+    // Last write time of the file when it was opened, in platform ticks
+    int64_t modifiedTime() const { return mapModifiedTime; }
+
+private:
+    const unsigned char* mapData{nullptr};
+    size_t mapSize{0};
+    int64_t mapModifiedTime{0};
+#if defined ARCH_WIN
+    void* fileHandle{nullptr};
+    void* mappingHandle{nullptr};
+#endif
+};
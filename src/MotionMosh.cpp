@@ -0,0 +1,171 @@
+#include "MotionMosh.hpp"
+#include "RenderScheduler.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Vector sets kept per loaded frame; random playback visits many pairs
+const size_t MAX_PAIRS_PER_FRAME = 4;
+
+int blockCount(int size) {
+    return (size + MotionMosh::BLOCK_SIZE - 1) / MotionMosh::BLOCK_SIZE;
+}
+
+void computeLuma(const unsigned char* rgba, std::vector<unsigned char>& luma, int width, int height) {
+    luma.resize(static_cast<size_t>(width) * height);
+    RenderScheduler::instance().parallelFor(blockCount(height), [&](int blockRow) {
+        int endY = std::min(height, (blockRow + 1) * MotionMosh::BLOCK_SIZE);
+        for (int y = blockRow * MotionMosh::BLOCK_SIZE; y < endY; y++) {
+            const unsigned char* src = rgba + static_cast<size_t>(y) * width * 4;
+            unsigned char* dst = luma.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                dst[x] = static_cast<unsigned char>((src[x * 4] * 77 + src[x * 4 + 1] * 150 + src[x * 4 + 2] * 29) >> 8);
+            }
+        }
+    });
+}
+
+} // end anonymous namespace
+
+void MotionMosh::clear() {
+    motionCache.clear();
+    cachedGif = nullptr;
+    kept = 0;
+}
+
+void MotionMosh::apply(std::vector<unsigned char>& output, int frameWidth, int frameHeight,
+                       const std::shared_ptr<const DecodedGif>& gif, size_t frame, float amount) {
+    // Only GIFs have source frames to follow
+    if (amount <= 0.0f || !gif || gif->width != frameWidth || gif->height != frameHeight) {
+        kept = 0;
+        return;
+    }
+    if (gif.get() != cachedGif) {
+        clear();
+        cachedGif = gif.get();
+    }
+    if (frameWidth != width || frameHeight != height) {
+        width = frameWidth;
+        height = frameHeight;
+        kept = 0;
+    }
+
+    if (kept > 0 && frame != latestFrame) {
+        // A new frame: the latest output becomes the picture to move around
+        reference.swap(latest);
+        referenceFrame = latestFrame;
+        kept = 2;
+    }
+
+    if (kept == 2 && referenceFrame != frame) {
+        compensate(output, motion(*gif, referenceFrame, frame), amount);
+    } else {
+        // Nothing older to mosh with yet
+        latest = output;
+        kept = std::max(kept, 1);
+    }
+    latestFrame = frame;
+}
+
+const std::vector<MotionMosh::MotionVector>& MotionMosh::motion(const DecodedGif& gif, size_t from, size_t to) {
+    auto key = std::make_pair(from, to);
+    auto cached = motionCache.find(key);
+    if (cached != motionCache.end()) {
+        return cached->second;
+    }
+
+    if (motionCache.size() >= gif.frames.size() * MAX_PAIRS_PER_FRAME) {
+        motionCache.clear();
+    }
+
+    computeLuma(gif.frames[from].pixels, fromLuma, width, height);
+    computeLuma(gif.frames[to].pixels, toLuma, width, height);
+    std::vector<MotionVector>& vectors = motionCache[key];
+    estimate(vectors);
+    return vectors;
+}
+
+// For each block of toLuma, find where it best comes from in fromLuma
+void MotionMosh::estimate(std::vector<MotionVector>& vectors) {
+    const int blocksX = blockCount(width);
+    const int blocksY = blockCount(height);
+    vectors.assign(static_cast<size_t>(blocksX) * blocksY, MotionVector());
+    static_assert(BLOCK_SIZE == 16, "the SAD kernels compare 16x16 blocks");
+    const SimdKernels& kernels = simdKernels();
+
+    RenderScheduler::instance().parallelFor(blocksY, [&](int by) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            int x = bx * BLOCK_SIZE;
+            int y = by * BLOCK_SIZE;
+            MotionVector& vector = vectors[by * blocksX + bx];
+            const unsigned char* target = toLuma.data() + static_cast<size_t>(y) * width + x;
+
+            if (x + BLOCK_SIZE > width || y + BLOCK_SIZE > height) {
+                // Partial blocks on the right and bottom edges stay in place
+                int blockWidth = std::min(BLOCK_SIZE, width - x);
+                int blockHeight = std::min(BLOCK_SIZE, height - y);
+                int sum = 0;
+                for (int row = 0; row < blockHeight; row++) {
+                    const unsigned char* a = target + row * width;
+                    const unsigned char* b = fromLuma.data() + static_cast<size_t>(y + row) * width + x;
+                    for (int col = 0; col < blockWidth; col++) {
+                        sum += std::abs(a[col] - b[col]);
+                    }
+                }
+                vector.error = static_cast<uint8_t>(sum / (blockWidth * blockHeight));
+                continue;
+            }
+
+            // Still blocks are common in GIFs, try no motion first
+            int best = kernels.blockSad(target, fromLuma.data() + static_cast<size_t>(y) * width + x, width);
+            int minDy = std::max(-SEARCH_RANGE, -y);
+            int maxDy = std::min(SEARCH_RANGE, height - BLOCK_SIZE - y);
+            int minDx = std::max(-SEARCH_RANGE, -x);
+            int maxDx = std::min(SEARCH_RANGE, width - BLOCK_SIZE - x);
+            for (int dy = minDy; dy <= maxDy && best > 0; dy++) {
+                const unsigned char* row = fromLuma.data() + static_cast<size_t>(y + dy) * width + x;
+                for (int dx = minDx; dx <= maxDx; dx++) {
+                    int sad = kernels.blockSad(target, row + dx, width);
+                    if (sad < best) {
+                        best = sad;
+                        vector.dx = static_cast<int8_t>(dx);
+                        vector.dy = static_cast<int8_t>(dy);
+                    }
+                }
+            }
+            vector.error = static_cast<uint8_t>(best / (BLOCK_SIZE * BLOCK_SIZE));
+        }
+    });
+}
+
+// Blocks predicted well enough are taken from the moved reference, the rest
+// keep the new frame. The result is also kept as the latest output.
+void MotionMosh::compensate(std::vector<unsigned char>& output, const std::vector<MotionVector>& vectors, float amount) {
+    const int blocksX = blockCount(width);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    // Squared so the low end of the knob only takes the best matches
+    const int errorLimit = static_cast<int>(amount * amount * 255.0f);
+    latest.resize(output.size());
+
+    RenderScheduler::instance().parallelFor(blockCount(height), [&](int by) {
+        int endY = std::min(height, (by + 1) * BLOCK_SIZE);
+        for (int bx = 0; bx < blocksX; bx++) {
+            const MotionVector& vector = vectors[by * blocksX + bx];
+            int x = bx * BLOCK_SIZE;
+            size_t blockBytes = static_cast<size_t>(std::min(BLOCK_SIZE, width - x)) * 4;
+            bool moshed = vector.error <= errorLimit;
+
+            for (int y = by * BLOCK_SIZE; y < endY; y++) {
+                unsigned char* out = output.data() + y * rowBytes + x * 4;
+                if (moshed) {
+                    const unsigned char* moved = reference.data() + (y + vector.dy) * rowBytes + (x + vector.dx) * 4;
+                    std::memcpy(out, moved, blockBytes);
+                }
+                std::memcpy(latest.data() + y * rowBytes + x * 4, out, blockBytes);
+            }
+        }
+    });
+}
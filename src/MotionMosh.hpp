@@ -0,0 +1,55 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include "GifCache.hpp"
+
+using namespace rack;
+
+// Motion datamosh: instead of showing a new GIF frame, the blocks of the
+// previously shown output are moved along the motion between the two source
+// frames, like a video decoder that lost its keyframes. Block motion is
+// searched once per frame pair and kept until another GIF is loaded.
+struct MotionMosh {
+    static constexpr int BLOCK_SIZE = 16;
+    // Largest displacement searched, in pixels each way
+    static constexpr int SEARCH_RANGE = 8;
+
+    // amount in 0..1 is how badly a block may be predicted and still be
+    // moshed, 0 skips the stage. frame indexes a frame of gif, whose pixels
+    // are the unprocessed source of output.
+    void apply(std::vector<unsigned char>& output, int width, int height,
+               const std::shared_ptr<const DecodedGif>& gif, size_t frame, float amount);
+    void clear();
+
+private:
+    struct MotionVector {
+        int8_t dx{0};
+        int8_t dy{0};
+        // Mean absolute luma difference left after moving the block
+        uint8_t error{0};
+    };
+
+    // Vectors from one source frame to another, one per block
+    std::map<std::pair<size_t, size_t>, std::vector<MotionVector>> motionCache;
+    const DecodedGif* cachedGif{nullptr};
+    std::vector<unsigned char> fromLuma;
+    std::vector<unsigned char> toLuma;
+
+    // Moshed output of the reference frame and of the latest frame; a
+    // re-render of the latest frame starts again from the reference
+    std::vector<unsigned char> reference;
+    std::vector<unsigned char> latest;
+    size_t referenceFrame{0};
+    size_t latestFrame{0};
+    // 0: nothing kept, 1: latest only, 2: reference and latest
+    int kept{0};
+    int width{0};
+    int height{0};
+
+    const std::vector<MotionVector>& motion(const DecodedGif& gif, size_t from, size_t to);
+    void estimate(std::vector<MotionVector>& vectors);
+    void compensate(std::vector<unsigned char>& output, const std::vector<MotionVector>& vectors, float amount);
+};
@@ -0,0 +1,51 @@
+#include "RenderGovernor.hpp"
+#include <algorithm>
+
+namespace {
+
+const char* const LEVEL_NAMES[RenderGovernor::NUM_LEVELS] = {
+    "Full", "No look-ahead", "Integer kernels", "Half rate"
+};
+
+} // end anonymous namespace
+
+const char* RenderGovernor::levelName(int level) {
+    return LEVEL_NAMES[rack::math::clamp(level, 0, NUM_LEVELS - 1)];
+}
+
+void RenderGovernor::recordRender(float seconds) {
+    int current = level;
+    float limit = budget;
+    renders = std::min(renders + 1, MAX_RESTORE_RENDERS);
+
+    // Half rate leaves two budgets per render
+    if (seconds > limit * (current == HALF_RATE ? 2.0f : 1.0f)) {
+        calmRenders = 0;
+        if (++slowRenders >= SLOW_RENDERS && current < NUM_LEVELS - 1) {
+            // Straight back down after a restore: wait longer before the next one
+            if (restored && renders < restoreWait) {
+                restoreWait = std::min(restoreWait * 2, MAX_RESTORE_RENDERS);
+            }
+            level = current + 1;
+            renders = 0;
+            slowRenders = 0;
+            restored = false;
+        }
+    } else if (seconds < limit * RESTORE_RATIO) {
+        slowRenders = 0;
+        if (++calmRenders >= restoreWait && current > FULL) {
+            level = current - 1;
+            renders = 0;
+            calmRenders = 0;
+            restored = true;
+        }
+    } else {
+        slowRenders = 0;
+        calmRenders = 0;
+    }
+
+    // The level held up for a good while, restores can be quick again
+    if (renders == MAX_RESTORE_RENDERS) {
+        restoreWait = RESTORE_RENDERS;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <rack.hpp>
+#include <atomic>
+
+using namespace rack;
+
+// Per-instance CPU budget. The render thread reports how long every
+// finished render took; a run of renders over budget drops the quality one
+// level, a longer run with plenty of headroom brings it back one level.
+// Levels are cumulative.
+struct RenderGovernor {
+    enum Level {
+        FULL,
+        NO_LOOKAHEAD,     // No pre-rendering of the next frames
+        INTEGER_KERNELS,  // FixedPointPipeline whenever it covers the params
+        HALF_RATE,        // At most one render every two budgets
+        NUM_LEVELS
+    };
+
+    // Stills and anything without a frame rate
+    static constexpr float DEFAULT_BUDGET = 1.0f / 30.0f;
+
+    static const char* levelName(int level);
+
+    // Time one render may take, from the engine thread; usually the
+    // playback frame period
+    void setBudget(float seconds) { budget = seconds; }
+    float getBudget() const { return budget; }
+
+    // From the render thread after every completed render
+    void recordRender(float seconds);
+
+    int getLevel() const { return level; }
+
+private:
+    // Renders over budget in a row needed to go down a level, so a single
+    // slow frame (a load, a GC pause) does not count
+    static constexpr int SLOW_RENDERS = 4;
+    // Renders under RESTORE_RATIO of the budget in a row needed to go up a level
+    static constexpr int RESTORE_RENDERS = 30;
+    // Longest wait, for a load that keeps bouncing between two levels
+    static constexpr int MAX_RESTORE_RENDERS = 480;
+    static constexpr float RESTORE_RATIO = 0.5f;
+
+    std::atomic<float> budget{DEFAULT_BUDGET};
+    std::atomic<int> level{FULL};
+    // Only touched by recordRender()
+    int renders{0};  // Since the last level change
+    int slowRenders{0};
+    int calmRenders{0};
+    int restoreWait{RESTORE_RENDERS};
+    bool restored{false};
+};
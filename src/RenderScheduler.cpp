@@ -0,0 +1,210 @@
+#include "RenderScheduler.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#if defined ARCH_LIN
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined ARCH_MAC
+#include <pthread.h>
+#elif defined ARCH_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+// Below the engine threads, so a render never delays an audio block. Set
+// GIFGLITCHER_RENDER_PRIORITY=normal to keep the default priority.
+void lowerThreadPriority() {
+    const char* priority = std::getenv("GIFGLITCHER_RENDER_PRIORITY");
+    if (priority && std::strcmp(priority, "normal") == 0) return;
+
+#if defined ARCH_LIN
+    // Nice value of this thread only; raising it back needs privileges
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#elif defined ARCH_MAC
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined ARCH_WIN
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#endif
+}
+
+} // end anonymous namespace
+
+RenderScheduler& RenderScheduler::instance() {
+    static RenderScheduler scheduler;
+    return scheduler;
+}
+
+RenderScheduler::~RenderScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    workCV.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void RenderScheduler::schedule(RenderClient* client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (client->suspended || client->running) {
+        // Picked up by resume() or when the current step ends
+        client->pending = true;
+        return;
+    }
+    if (!client->queued) {
+        enqueue(client);
+    }
+}
+
+void RenderScheduler::suspend(RenderClient* client) {
+    std::unique_lock<std::mutex> lock(mutex);
+    client->suspended = true;
+    if (client->queued) {
+        queue.erase(std::find(queue.begin(), queue.end(), client));
+        client->queued = false;
+        client->pending = true;
+    }
+    idleCV.wait(lock, [client] {
+        return !client->running;
+    });
+}
+
+void RenderScheduler::resume(RenderClient* client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    client->suspended = false;
+    if (client->pending) {
+        client->pending = false;
+        enqueue(client);
+    }
+}
+
+void RenderScheduler::start(unsigned count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    startThreads(count);
+}
+
+// mutex must be held
+void RenderScheduler::startThreads(unsigned count) {
+    if (!threads.empty()) return;
+    // Leave half the cores to the engine threads
+    if (count == 0) {
+        count = rack::math::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_THREADS);
+    }
+    for (unsigned i = 0; i < count; i++) {
+        threads.emplace_back(&RenderScheduler::workerFunction, this);
+    }
+    threadCount = threads.size();
+}
+
+// mutex must be held
+void RenderScheduler::enqueue(RenderClient* client) {
+    startThreads(0);
+
+    client->queued = true;
+    queue.push_back(client);
+    workCV.notify_one();
+}
+
+void RenderScheduler::parallelFor(int count, const std::function<void(int)>& body) {
+    // Nobody to share with
+    if (count <= 1 || threadCount <= 1 || serial) {
+        for (int i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    ParallelJob job;
+    job.body = &body;
+    job.count = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(&job);
+    }
+    workCV.notify_all();
+
+    runTiles(job);
+
+    // The job lives on this stack: unlist it, then wait for the helpers to leave
+    std::unique_lock<std::mutex> lock(mutex);
+    auto listed = std::find(jobs.begin(), jobs.end(), &job);
+    if (listed != jobs.end()) {
+        jobs.erase(listed);
+    }
+    jobCV.wait(lock, [&job] {
+        return job.done == job.count && job.helpers == 0;
+    });
+}
+
+void RenderScheduler::runTiles(ParallelJob& job) {
+    int ran = 0;
+    for (int i = job.next++; i < job.count; i = job.next++) {
+        (*job.body)(i);
+        ran++;
+    }
+
+    if (ran > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.done += ran;
+    }
+    jobCV.notify_all();
+}
+
+void RenderScheduler::workerFunction() {
+    system::setThreadName("GIFGlitcher render");
+    lowerThreadPriority();
+
+    while (true) {
+        RenderClient* client;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workCV.wait(lock, [this] {
+                return !running || !jobs.empty() || !queue.empty();
+            });
+            if (!running) break;
+
+            if (!jobs.empty()) {
+                ParallelJob* job = jobs.front();
+                if (job->next >= job->count) {
+                    // All tiles taken, the owner finishes the rest
+                    jobs.pop_front();
+                    continue;
+                }
+                job->helpers++;
+                lock.unlock();
+                runTiles(*job);
+                lock.lock();
+                job->helpers--;
+                lock.unlock();
+                jobCV.notify_all();
+                continue;
+            }
+
+            client = queue.front();
+            queue.pop_front();
+            client->queued = false;
+            client->running = true;
+            client->pending = false;
+        }
+
+        bool more = client->renderStep();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            client->running = false;
+            client->pending = client->pending || more;
+            // Back of the queue, so every other waiting client gets a turn first
+            if (client->pending && !client->suspended) {
+                client->pending = false;
+                enqueue(client);
+            }
+        }
+        idleCV.notify_all();
+    }
+}
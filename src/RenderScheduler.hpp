@@ -0,0 +1,94 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace rack;
+
+struct RenderScheduler;
+
+// Something the render threads can work for, e.g. one module instance
+struct RenderClient {
+    virtual ~RenderClient() {}
+
+    // Do one bounded piece of work, such as one frame. Returns true if there
+    // may be more to do, so the client is queued again behind the others.
+    virtual bool renderStep() = 0;
+
+    // Long renders poll this and give up early while a load is waiting
+    bool isRenderSuspended() const { return suspended; }
+
+private:
+    friend struct RenderScheduler;
+    // Guarded by the scheduler mutex
+    std::atomic<bool> suspended{false};
+    bool queued{false};
+    bool running{false};
+    bool pending{false};
+};
+
+// Plugin-wide pool of render threads shared by every instance. Clients are
+// served round robin, one step at a time, so a heavy instance cannot starve
+// the others. The threads start the first time any work is scheduled.
+struct RenderScheduler {
+    static constexpr unsigned MAX_THREADS = 4;
+
+    static RenderScheduler& instance();
+    ~RenderScheduler();
+
+    // Ask for a renderStep() soon. Cheap and non-blocking apart from a short
+    // lock, safe to call from the engine thread.
+    void schedule(RenderClient* client);
+
+    // Stop running the client and wait for a step in progress to finish.
+    // Work scheduled meanwhile is kept for resume().
+    void suspend(RenderClient* client);
+    void resume(RenderClient* client);
+
+    // Run body(i) for every i in [0, count) and return once all are done.
+    // Meant for splitting one frame into tiles from inside renderStep(): the
+    // calling thread takes tiles too, idle render threads help. body must
+    // not throw.
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    // Start the threads now instead of on the first schedule(); count 0
+    // picks the default. Lets a command line tool have parallelFor split
+    // tiles with no client running.
+    void start(unsigned count = 0);
+    // Run every parallelFor on the calling thread, as with a single thread,
+    // so tiled and serial results can be compared
+    void setSerial(bool serial) { this->serial = serial; }
+
+private:
+    struct ParallelJob {
+        const std::function<void(int)>* body;
+        int count;
+        std::atomic<int> next{0};
+        // Guarded by mutex
+        int done{0};
+        int helpers{0};
+    };
+
+    std::mutex mutex;
+    std::condition_variable workCV;
+    std::condition_variable idleCV;
+    std::condition_variable jobCV;
+    std::deque<RenderClient*> queue;
+    // Tile jobs come before client steps, someone is waiting on them
+    std::deque<ParallelJob*> jobs;
+    std::atomic<size_t> threadCount{0};
+    std::atomic<bool> serial{false};
+    std::vector<std::thread> threads;
+    bool running{true};
+
+    RenderScheduler() = default;
+    void startThreads(unsigned count);
+    void enqueue(RenderClient* client);
+    void runTiles(ParallelJob& job);
+    void workerFunction();
+};
@@ -0,0 +1,90 @@
+#include "ScanlineModulation.hpp"
+#include "GIFGlitcher.hpp"
+#include <algorithm>
+
+namespace {
+
+// Everything renderFrame's row stages (and the fixed point rows) read
+// straight from renderParams
+const std::array<float ProcessingParams::*, 18> ROW_FIELDS = {{
+    &ProcessingParams::brightness,
+    &ProcessingParams::contrast,
+    &ProcessingParams::saturation,
+    &ProcessingParams::hueShift,
+    &ProcessingParams::sharpness,
+    &ProcessingParams::pixelation,
+    &ProcessingParams::edgeDetect,
+    &ProcessingParams::rgbAberration,
+    &ProcessingParams::noise,
+    &ProcessingParams::glitchSlice,
+    &ProcessingParams::ditherIntensity,
+    &ProcessingParams::interlaceIntensity,
+    &ProcessingParams::glitchArtifacts,
+    &ProcessingParams::glitchBlockSize,
+    &ProcessingParams::glitchDisplacement,
+    &ProcessingParams::bitCrush,
+    &ProcessingParams::dataShift,
+    &ProcessingParams::pixelSort,
+}};
+
+} // end anonymous namespace
+
+void ScanlineModulation::push(const ProcessingParams& params, float sampleRate) {
+    sinceLastPush += CONTROL_RATE;
+    if (sinceLastPush < sampleRate) return;
+    sinceLastPush -= sampleRate;
+
+    // Seqlock style: claim the entry before writing it, so a collect()
+    // copying the entry CAPACITY back can tell it was overwritten
+    uint32_t h = head.load(std::memory_order_relaxed);
+    claimed.store(h + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    static_assert(ROW_FIELDS.size() == NUM_FIELDS, "one value per field");
+    SharedValues& values = ring[h & (CAPACITY - 1)];
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        values[i].store(params.*ROW_FIELDS[i], std::memory_order_relaxed);
+    }
+    head.store(h + 1, std::memory_order_release);
+}
+
+void ScanlineModulation::collect(float seconds) {
+    // Only the newest MAX_HISTORY entries are ever used; older ones may be
+    // overwritten already when no frame was rendered for a while
+    uint32_t h = head.load(std::memory_order_acquire);
+    if (h - tail > static_cast<uint32_t>(MAX_HISTORY)) {
+        tail = h - MAX_HISTORY;
+    }
+    size_t first = history.size();
+    for (uint32_t t = tail; t != h; t++) {
+        const SharedValues& entry = ring[t & (CAPACITY - 1)];
+        Values values;
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            values[i] = entry[i].load(std::memory_order_relaxed);
+        }
+        history.push_back(values);
+    }
+
+    // Copies of entries push() has started to overwrite since are torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t c = claimed.load(std::memory_order_relaxed);
+    uint32_t torn = 0;
+    for (uint32_t t = tail; t != h && c - t > CAPACITY; t++) {
+        torn++;
+    }
+    history.erase(history.begin() + first, history.begin() + first + torn);
+    tail = h;
+
+    if (history.size() > static_cast<size_t>(MAX_HISTORY)) {
+        history.erase(history.begin(), history.end() - MAX_HISTORY);
+    }
+    int wanted = std::max(1, static_cast<int>(seconds * CONTROL_RATE));
+    groups = std::min(wanted, static_cast<int>(history.size()));
+}
+
+void ScanlineModulation::applyGroup(int group, ProcessingParams& params) const {
+    const Values& values = history[history.size() - groups + group];
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        params.*ROW_FIELDS[i] = values[i];
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <rack.hpp>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+using namespace rack;
+
+struct ProcessingParams;
+
+// Audio-rate CV turned into per-row params. The engine pushes the row
+// level params at CONTROL_RATE into a single-producer single-consumer
+// ring; the render thread drains it and spreads the last frame period over
+// the rows of the frame, oldest at the top, like a CRT beam would see it.
+// Only params the row stages read on the fly are modulated: flags that
+// pick kernels, posterize (its kernel has no "off") and the whole-frame
+// stages keep the frame's value.
+struct ScanlineModulation {
+    static constexpr float CONTROL_RATE = 4000.0f;
+
+    // Engine thread, every sample. Never waits for the render thread: once
+    // the ring is full (nothing rendered for about a second) the newest
+    // values overwrite the oldest.
+    void push(const ProcessingParams& params, float sampleRate);
+
+    // Render thread: take everything pushed so far and use the last
+    // `seconds` of it for the next frames
+    void collect(float seconds);
+
+    // Render thread. Value sets for the frame, 0 before anything arrived.
+    int groupCount() const { return groups; }
+    int groupForRow(int y, int height) const { return static_cast<int>(static_cast<int64_t>(y) * groups / height); }
+    // Overwrite the modulated fields of params with value set `group`
+    void applyGroup(int group, ProcessingParams& params) const;
+
+private:
+    static constexpr int NUM_FIELDS = 18;
+    static constexpr uint32_t CAPACITY = 4096;
+    // About MAX_RENDER_BUDGET of history, enough for the longest frame
+    static constexpr int MAX_HISTORY = 512;
+
+    using Values = std::array<float, NUM_FIELDS>;
+    // Fields are atomics so collect() may copy an entry push() is
+    // overwriting; such a copy is found and dropped afterwards
+    using SharedValues = std::array<std::atomic<float>, NUM_FIELDS>;
+
+    std::unique_ptr<SharedValues[]> ring{new SharedValues[CAPACITY]};
+    std::atomic<uint32_t> head{0};     // Entries complete
+    std::atomic<uint32_t> claimed{0};  // Entries started, head or head + 1
+
+    // Engine thread only
+    float sinceLastPush{0.0f};
+
+    // Render thread only
+    uint32_t tail{0};
+    std::vector<Values> history;
+    int groups{0};
+};
@@ -0,0 +1,288 @@
+#include "SimdKernels.hpp"
+#include <rack.hpp>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char* const LEVEL_NAMES[NUM_SIMD_LEVELS] = {"sse2", "avx2", "avx512"};
+
+// 16 bytes per step in 16-bit lanes; the sum is at most 255 * 256 + 128, so
+// it still fits unsigned
+void mixRows(const unsigned char* current, const unsigned char* past, unsigned char* out,
+             unsigned char* record, size_t bytes, int weight) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i currentWeight = _mm_set1_epi16(static_cast<short>(256 - weight));
+    const __m128i pastWeight = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i half = _mm_set1_epi16(128);
+
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i));
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(past + i));
+
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), currentWeight),
+                                    _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), pastWeight));
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), currentWeight),
+                                     _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), pastWeight));
+        low = _mm_srli_epi16(_mm_add_epi16(low, half), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, half), 8);
+
+        __m128i mixed = _mm_packus_epi16(low, high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), mixed);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(record + i), mixed);
+    }
+    for (; i < bytes; i++) {
+        unsigned char mixed = static_cast<unsigned char>((current[i] * (256 - weight) + past[i] * weight + 128) >> 8);
+        out[i] = mixed;
+        record[i] = mixed;
+    }
+}
+
+// One row per _mm_sad_epu8
+int blockSad(const unsigned char* a, const unsigned char* b, int stride) {
+    __m128i sum = _mm_setzero_si128();
+    for (int row = 0; row < 16; row++) {
+        __m128i rowA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + row * stride));
+        __m128i rowB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + row * stride));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(rowA, rowB));
+    }
+    return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+}
+
+// One pixel per vector: the 4 lanes load R, G, B and the next column's R,
+// which lands on alpha and is replaced by the old alpha
+void boxRow(const uint32_t* top, const uint32_t* bottom, int radius, float scale,
+            int begin, int end, unsigned char* out) {
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int x = begin;
+    for (; x + 4 <= end; x += 4) {
+        __m128i averages[4];
+        for (int i = 0; i < 4; i++) {
+            size_t x0 = static_cast<size_t>(x + i - radius) * 3;
+            size_t x1 = static_cast<size_t>(x + i + radius + 1) * 3;
+            __m128i sum = _mm_sub_epi32(
+                _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x1)),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x0))),
+                _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x0)),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x1))));
+            averages[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scales), half));
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(averages[0], averages[1]),
+                                          _mm_packs_epi32(averages[2], averages[3]));
+        __m128i* target = reinterpret_cast<__m128i*>(out + x * 4);
+        __m128i old = _mm_loadu_si128(target);
+        _mm_storeu_si128(target, _mm_or_si128(_mm_and_si128(alpha, old), _mm_andnot_si128(alpha, packed)));
+    }
+    for (; x < end; x++) {
+        size_t x0 = static_cast<size_t>(x - radius) * 3;
+        size_t x1 = static_cast<size_t>(x + radius + 1) * 3;
+        for (int c = 0; c < 3; c++) {
+            uint32_t sum = bottom[x1 + c] - bottom[x0 + c] - top[x1 + c] + top[x0 + c];
+            out[x * 4 + c] = static_cast<unsigned char>(sum * scale + 0.5f);
+        }
+    }
+}
+
+// SSE2 has no gather
+void expandPalette(const unsigned char* indices, const uint32_t* palette, unsigned char* out, int count) {
+    for (int i = 0; i < count; i++) {
+        const unsigned char* color = reinterpret_cast<const unsigned char*>(palette + indices[i]);
+        if (color[3]) {
+            std::memcpy(out + i * 4, color, 4);
+        }
+    }
+}
+
+// a * factor >> 8, for a factor stored << 5 by FixedPointPipeline
+inline __m128i mulFixed(__m128i a, __m128i factor) {
+    return _mm_mulhi_epi16(_mm_slli_epi16(a, 3), factor);
+}
+
+// Byte 0..255 to 8.8, 255 becomes 1.0
+inline __m128i fromByte(__m128i b) {
+    return _mm_add_epi16(b, _mm_srai_epi16(b, 7));
+}
+
+// 8.8 to byte, value * 255 rounded; the exact inverse of fromByte, so a
+// channel no stage touched comes out unchanged
+inline __m128i toByte(__m128i v) {
+    return _mm_sub_epi16(v, _mm_srai_epi16(_mm_add_epi16(v, _mm_set1_epi16(127)), 8));
+}
+
+// Every colour lane gets max(r, g, b) of its pixel; works on both pixels
+inline __m128i maxRgb(__m128i v) {
+    __m128i gbr = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 2, 1)), _MM_SHUFFLE(3, 0, 2, 1));
+    __m128i brg = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 0, 2)), _MM_SHUFFLE(3, 1, 0, 2));
+    return _mm_max_epi16(v, _mm_max_epi16(gbr, brg));
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Two RGBA pixels per register, four per step
+void fixedPointRow(const FixedPointRow& row, const unsigned char* in, unsigned char* out, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(256);
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i alphaBytes = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i contrastFactor = _mm_set1_epi16(row.contrast);
+    const __m128i offset = _mm_set1_epi16(row.levelOffset);
+    const __m128i saturationFactor = _mm_set1_epi16(row.saturation);
+    const __m128i levelCount = _mm_set1_epi16(row.levels);
+    const __m128i step = _mm_set1_epi16(row.levelStep);
+    const __m128i crushMask = _mm_set1_epi16(row.bitMask);
+    const __m128i noiseFactor = _mm_set1_epi16(row.noiseGain);
+    const __m128i interlaceFactor = _mm_set1_epi16(row.interlaceGain);
+
+    // Dither offsets for pixels x % 8 in 0..3 and 4..7, colour lanes only
+    __m128i ditherLanes[4];
+    if (row.dither) {
+        for (int i = 0; i < 4; i++) {
+            int16_t a = row.dither[i * 2];
+            int16_t b = row.dither[i * 2 + 1];
+            ditherLanes[i] = _mm_setr_epi16(a, a, a, 0, b, b, b, 0);
+        }
+    }
+
+    __m128i noiseLanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.noiseState));
+
+    for (int x = 0; x < width; x += 4) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4));
+        __m128i pixels[2] = {fromByte(_mm_unpacklo_epi8(bytes, zero)), fromByte(_mm_unpackhi_epi8(bytes, zero))};
+
+        for (int i = 0; i < 2; i++) {
+            __m128i v = pixels[i];
+
+            if (row.adjustLevels) {
+                v = _mm_adds_epi16(mulFixed(_mm_sub_epi16(v, half), contrastFactor), offset);
+            }
+            if (row.saturate) {
+                __m128i maxValue = maxRgb(v);
+                __m128i saturated = _mm_sub_epi16(maxValue, mulFixed(_mm_sub_epi16(maxValue, v), saturationFactor));
+                // The float path turns pixels with no positive channel grey
+                v = select(_mm_cmpgt_epi16(maxValue, zero), saturated, maxValue);
+            }
+            if (row.dither) {
+                v = _mm_adds_epi16(v, ditherLanes[(x % 8) / 2 + i]);
+            }
+            if (row.posterize) {
+                __m128i level = _mm_mulhi_epi16(v, levelCount);
+                v = _mm_mulhi_epi16(_mm_slli_epi16(level, 9), step);
+            }
+            if (row.bitCrush) {
+                v = fromByte(_mm_and_si128(toByte(v), crushMask));
+            }
+            if (row.interlace) {
+                v = mulFixed(v, interlaceFactor);
+            }
+            if (row.noise) {
+                noiseLanes = _mm_xor_si128(noiseLanes, _mm_slli_epi32(noiseLanes, 13));
+                noiseLanes = _mm_xor_si128(noiseLanes, _mm_srli_epi32(noiseLanes, 17));
+                noiseLanes = _mm_xor_si128(noiseLanes, _mm_slli_epi32(noiseLanes, 5));
+                v = _mm_adds_epi16(v, _mm_mulhi_epi16(noiseLanes, noiseFactor));
+                v = _mm_min_epi16(_mm_max_epi16(v, zero), one);
+            }
+            if (row.invert) {
+                v = _mm_sub_epi16(one, v);
+            }
+
+            pixels[i] = toByte(_mm_min_epi16(_mm_max_epi16(v, zero), one));
+        }
+
+        // Alpha is passed through untouched
+        __m128i result = _mm_packus_epi16(pixels[0], pixels[1]);
+        result = select(alphaBytes, bytes, result);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), result);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row.noiseState), noiseLanes);
+}
+
+const SimdKernels sse2 = {mixRows, blockSad, boxRow, expandPalette, fixedPointRow};
+
+const SimdKernels* active = &sse2;
+SimdLevel activeLevel = SIMD_SSE2;
+
+const SimdKernels* kernelsFor(int level) {
+    switch (level) {
+        case SIMD_AVX2: return avx2Kernels();
+        case SIMD_AVX512: return avx512Kernels();
+        default: return sse2Kernels();
+    }
+}
+
+bool cpuSupports(int level) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    switch (level) {
+        case SIMD_AVX2: return __builtin_cpu_supports("avx2");
+        case SIMD_AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        default: return true;
+    }
+#else
+    return level == SIMD_SSE2;
+#endif
+}
+
+} // end anonymous namespace
+
+const SimdKernels* sse2Kernels() {
+    return &sse2;
+}
+
+SimdLevel detectSimdLevel() {
+    for (int level = NUM_SIMD_LEVELS - 1; level > SIMD_SSE2; level--) {
+        if (kernelsFor(level) && cpuSupports(level)) {
+            return static_cast<SimdLevel>(level);
+        }
+    }
+    return SIMD_SSE2;
+}
+
+void selectSimdKernels() {
+    SimdLevel level = detectSimdLevel();
+
+    // For benchmarking one level against another on the same machine
+    const char* forced = std::getenv("GIFGLITCHER_SIMD");
+    if (forced) {
+        int requested = -1;
+        for (int i = 0; i < NUM_SIMD_LEVELS; i++) {
+            if (std::strcmp(forced, LEVEL_NAMES[i]) == 0) {
+                requested = i;
+            }
+        }
+        if (requested >= 0 && requested <= level) {
+            level = static_cast<SimdLevel>(requested);
+        } else {
+            WARN("GIFGLITCHER_SIMD=%s is not available here, using %s", forced, LEVEL_NAMES[level]);
+        }
+    }
+
+    active = kernelsFor(level);
+    activeLevel = level;
+    INFO("GIFGlitcher pixel kernels: %s", LEVEL_NAMES[level]);
+}
+
+SimdLevel activeSimdLevel() {
+    return activeLevel;
+}
+
+bool useSimdLevel(SimdLevel level) {
+    if (level < SIMD_SSE2 || level > detectSimdLevel() || !kernelsFor(level)) return false;
+    active = kernelsFor(level);
+    activeLevel = level;
+    return true;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    return LEVEL_NAMES[level];
+}
+
+const SimdKernels& simdKernels() {
+    return *active;
+}
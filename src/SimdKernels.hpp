@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The hottest pixel loops, built once per instruction set and picked at
+// plugin init for the CPU we run on. The AVX files are compiled with AVX
+// flags, so this header stays free of rack.hpp and the standard library:
+// inline code from those, built with AVX, could be linked in for every CPU.
+
+enum SimdLevel {
+    SIMD_SSE2,    // Baseline; through simde on ARM
+    SIMD_AVX2,
+    SIMD_AVX512,  // AVX-512 F and BW
+    NUM_SIMD_LEVELS
+};
+
+// Constants of one FixedPointPipeline row; values are 8.8 fixed point and
+// the factors are pre-shifted for its mulFixed (see FixedPointPipeline.cpp)
+struct FixedPointRow {
+    bool adjustLevels;
+    int16_t contrast;
+    int16_t levelOffset;
+    bool saturate;
+    int16_t saturation;
+    const int16_t* dither;  // Offsets of the 8 Bayer cells of this row, or null
+    bool posterize;
+    int16_t levels;
+    int16_t levelStep;
+    bool bitCrush;
+    int16_t bitMask;
+    bool interlace;  // This row is darkened
+    int16_t interlaceGain;
+    bool noise;
+    int16_t noiseGain;
+    // 4 xorshift32 lanes, stepped twice per 4 pixels on every level so the
+    // noise comes out the same
+    uint32_t* noiseState;
+    bool invert;
+};
+
+struct SimdKernels {
+    // out = (current * (256 - weight) + past * weight + 128) >> 8, written to
+    // both out and record. out may be current.
+    void (*mixRows)(const unsigned char* current, const unsigned char* past, unsigned char* out,
+                    unsigned char* record, size_t bytes, int weight);
+
+    // Sum of absolute differences of two 16x16 luma blocks
+    int (*blockSad)(const unsigned char* a, const unsigned char* b, int stride);
+
+    // Box averages for pixels begin..end-1 of an RGBA row, from two rows of
+    // a summed-area table with 3 channels per column. Every box spans
+    // columns x - radius to x + radius + 1, so one scale fits all; alpha in
+    // out is kept. Reads one value past the last column used.
+    void (*boxRow)(const uint32_t* top, const uint32_t* bottom, int radius, float scale,
+                   int begin, int end, unsigned char* out);
+
+    // RGBA of each palette index; entries with alpha 0 leave out unchanged
+    void (*expandPalette)(const unsigned char* indices, const uint32_t* palette,
+                          unsigned char* out, int count);
+
+    // Colour stages of a FixedPointPipeline row from in to out. Both are
+    // padded to a multiple of 8 pixels, and width rounded up to 4 pixels
+    // is written.
+    void (*fixedPointRow)(const FixedPointRow& row, const unsigned char* in, unsigned char* out, int width);
+};
+
+// Null when the plugin was built without that instruction set
+const SimdKernels* sse2Kernels();
+const SimdKernels* avx2Kernels();
+const SimdKernels* avx512Kernels();
+
+// Best level this CPU and build support
+SimdLevel detectSimdLevel();
+
+// Called from init(). Uses detectSimdLevel() unless GIFGLITCHER_SIMD is set
+// to sse2, avx2 or avx512, which forces that level if it is available.
+void selectSimdKernels();
+
+SimdLevel activeSimdLevel();
+const SimdKernels& simdKernels();
+
+// Switch to another level at runtime, for tools/render-verify; only while
+// nothing renders. False if this CPU or build lacks it.
+bool useSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
@@ -0,0 +1,235 @@
+// Built with -mavx2 on x64 (see the Makefile); only ever called once
+// selectSimdKernels() has seen the CPU support it
+#include "SimdKernels.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#include <cstring>
+
+namespace {
+
+// Same arithmetic as the SSE2 version, 32 bytes per step. Unpack and pack
+// both work within 128-bit halves, so the byte order comes out right.
+void mixRows(const unsigned char* current, const unsigned char* past, unsigned char* out,
+             unsigned char* record, size_t bytes, int weight) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i currentWeight = _mm256_set1_epi16(static_cast<short>(256 - weight));
+    const __m256i pastWeight = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i half = _mm256_set1_epi16(128);
+
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + i));
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(past + i));
+
+        __m256i low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zero), currentWeight),
+                                       _mm256_mullo_epi16(_mm256_unpacklo_epi8(p, zero), pastWeight));
+        __m256i high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zero), currentWeight),
+                                        _mm256_mullo_epi16(_mm256_unpackhi_epi8(p, zero), pastWeight));
+        low = _mm256_srli_epi16(_mm256_add_epi16(low, half), 8);
+        high = _mm256_srli_epi16(_mm256_add_epi16(high, half), 8);
+
+        __m256i mixed = _mm256_packus_epi16(low, high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), mixed);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(record + i), mixed);
+    }
+    for (; i < bytes; i++) {
+        unsigned char mixed = static_cast<unsigned char>((current[i] * (256 - weight) + past[i] * weight + 128) >> 8);
+        out[i] = mixed;
+        record[i] = mixed;
+    }
+}
+
+inline __m256i loadRows(const unsigned char* p, int stride) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + stride)), 1);
+}
+
+// Two rows per _mm256_sad_epu8
+int blockSad(const unsigned char* a, const unsigned char* b, int stride) {
+    __m256i sum = _mm256_setzero_si256();
+    for (int row = 0; row < 16; row += 2) {
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(loadRows(a + row * stride, stride),
+                                                    loadRows(b + row * stride, stride)));
+    }
+    __m128i total = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+}
+
+// Box sums of pixels x and x + 1, one per 128-bit half
+inline __m256i boxSums(const uint32_t* top, const uint32_t* bottom, int x, int radius) {
+    size_t x0 = static_cast<size_t>(x - radius) * 3;
+    size_t x1 = static_cast<size_t>(x + radius + 1) * 3;
+    auto load = [](const uint32_t* p) {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3)), 1);
+    };
+    return _mm256_sub_epi32(_mm256_add_epi32(load(bottom + x1), load(top + x0)),
+                            _mm256_add_epi32(load(bottom + x0), load(top + x1)));
+}
+
+void boxRow(const uint32_t* top, const uint32_t* bottom, int radius, float scale,
+            int begin, int end, unsigned char* out) {
+    const __m256 scales = _mm256_set1_ps(scale);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    // The packs leave pixels 0 2 4 6 in the low half and 1 3 5 7 in the high one
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    int x = begin;
+    for (; x + 8 <= end; x += 8) {
+        __m256i averages[4];
+        for (int i = 0; i < 4; i++) {
+            __m256 sums = _mm256_cvtepi32_ps(boxSums(top, bottom, x + i * 2, radius));
+            averages[i] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(sums, scales), half));
+        }
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(averages[0], averages[1]),
+                                             _mm256_packs_epi32(averages[2], averages[3]));
+        packed = _mm256_permutevar8x32_epi32(packed, order);
+        __m256i* target = reinterpret_cast<__m256i*>(out + x * 4);
+        _mm256_storeu_si256(target, _mm256_blendv_epi8(packed, _mm256_loadu_si256(target), alpha));
+    }
+    for (; x < end; x++) {
+        size_t x0 = static_cast<size_t>(x - radius) * 3;
+        size_t x1 = static_cast<size_t>(x + radius + 1) * 3;
+        for (int c = 0; c < 3; c++) {
+            uint32_t sum = bottom[x1 + c] - bottom[x0 + c] - top[x1 + c] + top[x0 + c];
+            out[x * 4 + c] = static_cast<unsigned char>(sum * scale + 0.5f);
+        }
+    }
+}
+
+// 8 pixels per gather, masked store skips transparent entries
+void expandPalette(const unsigned char* indices, const uint32_t* palette, unsigned char* out, int count) {
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i)));
+        __m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), index, 4);
+        __m256i hidden = _mm256_cmpeq_epi32(_mm256_and_si256(colors, alphaMask), zero);
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(out + i * 4), _mm256_xor_si256(hidden, _mm256_set1_epi32(-1)),
+                               colors);
+    }
+    for (; i < count; i++) {
+        uint32_t color = palette[indices[i]];
+        if (color & 0xFF000000u) {
+            std::memcpy(out + i * 4, &color, 4);
+        }
+    }
+}
+
+// Same fixed point helpers as the SSE2 row, on both 128-bit halves
+inline __m256i mulFixed(__m256i a, __m256i factor) {
+    return _mm256_mulhi_epi16(_mm256_slli_epi16(a, 3), factor);
+}
+
+inline __m256i fromByte(__m256i b) {
+    return _mm256_add_epi16(b, _mm256_srai_epi16(b, 7));
+}
+
+inline __m256i toByte(__m256i v) {
+    return _mm256_sub_epi16(v, _mm256_srai_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(127)), 8));
+}
+
+inline __m256i maxRgb(__m256i v) {
+    __m256i gbr = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 2, 1)), _MM_SHUFFLE(3, 0, 2, 1));
+    __m256i brg = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 0, 2)), _MM_SHUFFLE(3, 1, 0, 2));
+    return _mm256_max_epi16(v, _mm256_max_epi16(gbr, brg));
+}
+
+inline __m128i xorshift(__m128i state) {
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    return _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+}
+
+// Four pixels per register and step. The SSE2 row steps the noise once
+// per two pixels, so the two halves take consecutive states.
+void fixedPointRow(const FixedPointRow& row, const unsigned char* in, unsigned char* out, int width) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(256);
+    const __m256i half = _mm256_set1_epi16(128);
+    const __m128i alphaBytes = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i contrastFactor = _mm256_set1_epi16(row.contrast);
+    const __m256i offset = _mm256_set1_epi16(row.levelOffset);
+    const __m256i saturationFactor = _mm256_set1_epi16(row.saturation);
+    const __m256i levelCount = _mm256_set1_epi16(row.levels);
+    const __m256i step = _mm256_set1_epi16(row.levelStep);
+    const __m256i crushMask = _mm256_set1_epi16(row.bitMask);
+    const __m256i noiseFactor = _mm256_set1_epi16(row.noiseGain);
+    const __m256i interlaceFactor = _mm256_set1_epi16(row.interlaceGain);
+
+    // Dither offsets for pixels x % 8 in 0..3 and 4..7, colour lanes only
+    __m256i ditherLanes[2] = {zero, zero};
+    if (row.dither) {
+        const int16_t* d = row.dither;
+        ditherLanes[0] = _mm256_setr_epi16(d[0], d[0], d[0], 0, d[1], d[1], d[1], 0,
+                                           d[2], d[2], d[2], 0, d[3], d[3], d[3], 0);
+        ditherLanes[1] = _mm256_setr_epi16(d[4], d[4], d[4], 0, d[5], d[5], d[5], 0,
+                                           d[6], d[6], d[6], 0, d[7], d[7], d[7], 0);
+    }
+
+    __m128i noiseState = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.noiseState));
+
+    for (int x = 0; x < width; x += 4) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4));
+        __m256i v = fromByte(_mm256_cvtepu8_epi16(bytes));
+
+        if (row.adjustLevels) {
+            v = _mm256_adds_epi16(mulFixed(_mm256_sub_epi16(v, half), contrastFactor), offset);
+        }
+        if (row.saturate) {
+            __m256i maxValue = maxRgb(v);
+            __m256i saturated = _mm256_sub_epi16(maxValue, mulFixed(_mm256_sub_epi16(maxValue, v), saturationFactor));
+            v = _mm256_blendv_epi8(maxValue, saturated, _mm256_cmpgt_epi16(maxValue, zero));
+        }
+        if (row.dither) {
+            v = _mm256_adds_epi16(v, ditherLanes[(x % 8) / 4]);
+        }
+        if (row.posterize) {
+            __m256i level = _mm256_mulhi_epi16(v, levelCount);
+            v = _mm256_mulhi_epi16(_mm256_slli_epi16(level, 9), step);
+        }
+        if (row.bitCrush) {
+            v = fromByte(_mm256_and_si256(toByte(v), crushMask));
+        }
+        if (row.interlace) {
+            v = mulFixed(v, interlaceFactor);
+        }
+        if (row.noise) {
+            __m128i first = xorshift(noiseState);
+            noiseState = xorshift(first);
+            __m256i noiseLanes = _mm256_inserti128_si256(_mm256_castsi128_si256(first), noiseState, 1);
+            v = _mm256_adds_epi16(v, _mm256_mulhi_epi16(noiseLanes, noiseFactor));
+            v = _mm256_min_epi16(_mm256_max_epi16(v, zero), one);
+        }
+        if (row.invert) {
+            v = _mm256_sub_epi16(one, v);
+        }
+
+        v = toByte(_mm256_min_epi16(_mm256_max_epi16(v, zero), one));
+        __m128i result = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        result = _mm_blendv_epi8(result, bytes, alphaBytes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), result);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row.noiseState), noiseState);
+}
+
+const SimdKernels avx2 = {mixRows, blockSad, boxRow, expandPalette, fixedPointRow};
+
+} // end anonymous namespace
+
+const SimdKernels* avx2Kernels() {
+    return &avx2;
+}
+
+#else
+
+const SimdKernels* avx2Kernels() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,235 @@
+// Built with -mavx512f -mavx512bw on x64 (see the Makefile); only ever
+// called once selectSimdKernels() has seen the CPU support it
+#include "SimdKernels.hpp"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#include <immintrin.h>
+#include <cstring>
+
+namespace {
+
+// Same arithmetic as the SSE2 version, 64 bytes per step
+void mixRows(const unsigned char* current, const unsigned char* past, unsigned char* out,
+             unsigned char* record, size_t bytes, int weight) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i currentWeight = _mm512_set1_epi16(static_cast<short>(256 - weight));
+    const __m512i pastWeight = _mm512_set1_epi16(static_cast<short>(weight));
+    const __m512i half = _mm512_set1_epi16(128);
+
+    size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        __m512i c = _mm512_loadu_si512(current + i);
+        __m512i p = _mm512_loadu_si512(past + i);
+
+        __m512i low = _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpacklo_epi8(c, zero), currentWeight),
+                                       _mm512_mullo_epi16(_mm512_unpacklo_epi8(p, zero), pastWeight));
+        __m512i high = _mm512_add_epi16(_mm512_mullo_epi16(_mm512_unpackhi_epi8(c, zero), currentWeight),
+                                        _mm512_mullo_epi16(_mm512_unpackhi_epi8(p, zero), pastWeight));
+        low = _mm512_srli_epi16(_mm512_add_epi16(low, half), 8);
+        high = _mm512_srli_epi16(_mm512_add_epi16(high, half), 8);
+
+        __m512i mixed = _mm512_packus_epi16(low, high);
+        _mm512_storeu_si512(out + i, mixed);
+        _mm512_storeu_si512(record + i, mixed);
+    }
+    for (; i < bytes; i++) {
+        unsigned char mixed = static_cast<unsigned char>((current[i] * (256 - weight) + past[i] * weight + 128) >> 8);
+        out[i] = mixed;
+        record[i] = mixed;
+    }
+}
+
+// Four 128-bit pieces p, p + step, p + 2 * step, p + 3 * step
+template <typename T>
+inline __m512i loadQuarters(const T* p, size_t step) {
+    __m512i v = _mm512_castsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + step)), 1);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + step * 2)), 2);
+    return _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + step * 3)), 3);
+}
+
+// Four rows per _mm512_sad_epu8
+int blockSad(const unsigned char* a, const unsigned char* b, int stride) {
+    __m512i sum = _mm512_setzero_si512();
+    for (int row = 0; row < 16; row += 4) {
+        sum = _mm512_add_epi64(sum, _mm512_sad_epu8(loadQuarters(a + row * stride, stride),
+                                                    loadQuarters(b + row * stride, stride)));
+    }
+    return static_cast<int>(_mm512_reduce_add_epi64(sum));
+}
+
+void boxRow(const uint32_t* top, const uint32_t* bottom, int radius, float scale,
+            int begin, int end, unsigned char* out) {
+    const __m512 scales = _mm512_set1_ps(scale);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    // After the packs, 128-bit piece j holds pixels j, j + 4, j + 8, j + 12
+    const __m512i order = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    // Colour bytes only, alpha stays as it is
+    const __mmask64 colorBytes = 0x7777777777777777ull;
+
+    int x = begin;
+    for (; x + 16 <= end; x += 16) {
+        __m512i averages[4];
+        for (int i = 0; i < 4; i++) {
+            size_t x0 = static_cast<size_t>(x + i * 4 - radius) * 3;
+            size_t x1 = static_cast<size_t>(x + i * 4 + radius + 1) * 3;
+            __m512i sums = _mm512_sub_epi32(_mm512_add_epi32(loadQuarters(bottom + x1, 3), loadQuarters(top + x0, 3)),
+                                            _mm512_add_epi32(loadQuarters(bottom + x0, 3), loadQuarters(top + x1, 3)));
+            averages[i] = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(sums), scales), half));
+        }
+        __m512i packed = _mm512_packus_epi16(_mm512_packs_epi32(averages[0], averages[1]),
+                                             _mm512_packs_epi32(averages[2], averages[3]));
+        _mm512_mask_storeu_epi8(out + x * 4, colorBytes, _mm512_permutexvar_epi32(order, packed));
+    }
+    for (; x < end; x++) {
+        size_t x0 = static_cast<size_t>(x - radius) * 3;
+        size_t x1 = static_cast<size_t>(x + radius + 1) * 3;
+        for (int c = 0; c < 3; c++) {
+            uint32_t sum = bottom[x1 + c] - bottom[x0 + c] - top[x1 + c] + top[x0 + c];
+            out[x * 4 + c] = static_cast<unsigned char>(sum * scale + 0.5f);
+        }
+    }
+}
+
+// 16 pixels per gather, masked store skips transparent entries
+void expandPalette(const unsigned char* indices, const uint32_t* palette, unsigned char* out, int count) {
+    const __m512i alphaMask = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i index = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)));
+        __m512i colors = _mm512_i32gather_epi32(index, palette, 4);
+        _mm512_mask_storeu_epi32(out + i * 4, _mm512_test_epi32_mask(colors, alphaMask), colors);
+    }
+    for (; i < count; i++) {
+        uint32_t color = palette[indices[i]];
+        if (color & 0xFF000000u) {
+            std::memcpy(out + i * 4, &color, 4);
+        }
+    }
+}
+
+// Same fixed point helpers as the SSE2 row, on all four 128-bit pieces
+inline __m512i mulFixed(__m512i a, __m512i factor) {
+    return _mm512_mulhi_epi16(_mm512_slli_epi16(a, 3), factor);
+}
+
+inline __m512i fromByte(__m512i b) {
+    return _mm512_add_epi16(b, _mm512_srai_epi16(b, 7));
+}
+
+inline __m512i toByte(__m512i v) {
+    return _mm512_sub_epi16(v, _mm512_srai_epi16(_mm512_add_epi16(v, _mm512_set1_epi16(127)), 8));
+}
+
+inline __m512i maxRgb(__m512i v) {
+    __m512i gbr = _mm512_shufflehi_epi16(_mm512_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 2, 1)), _MM_SHUFFLE(3, 0, 2, 1));
+    __m512i brg = _mm512_shufflehi_epi16(_mm512_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 0, 2)), _MM_SHUFFLE(3, 1, 0, 2));
+    return _mm512_max_epi16(v, _mm512_max_epi16(gbr, brg));
+}
+
+inline __m128i xorshift(__m128i state) {
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    return _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+}
+
+// Eight pixels per register and step. The SSE2 row steps the noise once
+// per two pixels, so the pieces take consecutive states, and a last step
+// of four pixels or fewer only takes two, as SSE2 would.
+void fixedPointRow(const FixedPointRow& row, const unsigned char* in, unsigned char* out, int width) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi16(256);
+    const __m512i half = _mm512_set1_epi16(128);
+    const __m256i alphaBytes = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m512i contrastFactor = _mm512_set1_epi16(row.contrast);
+    const __m512i offset = _mm512_set1_epi16(row.levelOffset);
+    const __m512i saturationFactor = _mm512_set1_epi16(row.saturation);
+    const __m512i levelCount = _mm512_set1_epi16(row.levels);
+    const __m512i step = _mm512_set1_epi16(row.levelStep);
+    const __m512i crushMask = _mm512_set1_epi16(row.bitMask);
+    const __m512i noiseFactor = _mm512_set1_epi16(row.noiseGain);
+    const __m512i interlaceFactor = _mm512_set1_epi16(row.interlaceGain);
+
+    // x is always a multiple of 8, so one vector covers the Bayer row
+    __m512i ditherLanes = zero;
+    if (row.dither) {
+        int16_t lanes[32];
+        for (int i = 0; i < 8; i++) {
+            lanes[i * 4] = lanes[i * 4 + 1] = lanes[i * 4 + 2] = row.dither[i];
+            lanes[i * 4 + 3] = 0;
+        }
+        ditherLanes = _mm512_loadu_si512(lanes);
+    }
+
+    __m128i noiseState = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.noiseState));
+
+    for (int x = 0; x < width; x += 8) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + x * 4));
+        __m512i v = fromByte(_mm512_cvtepu8_epi16(bytes));
+
+        if (row.adjustLevels) {
+            v = _mm512_adds_epi16(mulFixed(_mm512_sub_epi16(v, half), contrastFactor), offset);
+        }
+        if (row.saturate) {
+            __m512i maxValue = maxRgb(v);
+            __m512i saturated = _mm512_sub_epi16(maxValue, mulFixed(_mm512_sub_epi16(maxValue, v), saturationFactor));
+            v = _mm512_mask_blend_epi16(_mm512_cmpgt_epi16_mask(maxValue, zero), maxValue, saturated);
+        }
+        if (row.dither) {
+            v = _mm512_adds_epi16(v, ditherLanes);
+        }
+        if (row.posterize) {
+            __m512i level = _mm512_mulhi_epi16(v, levelCount);
+            v = _mm512_mulhi_epi16(_mm512_slli_epi16(level, 9), step);
+        }
+        if (row.bitCrush) {
+            v = fromByte(_mm512_and_si512(toByte(v), crushMask));
+        }
+        if (row.interlace) {
+            v = mulFixed(v, interlaceFactor);
+        }
+        if (row.noise) {
+            __m128i first = xorshift(noiseState);
+            __m128i second = xorshift(first);
+            __m128i third = second;
+            noiseState = second;
+            if (x + 4 < width) {
+                third = xorshift(second);
+                noiseState = xorshift(third);
+            }
+            __m512i noiseLanes = _mm512_castsi128_si512(first);
+            noiseLanes = _mm512_inserti32x4(noiseLanes, second, 1);
+            noiseLanes = _mm512_inserti32x4(noiseLanes, third, 2);
+            noiseLanes = _mm512_inserti32x4(noiseLanes, noiseState, 3);
+            v = _mm512_adds_epi16(v, _mm512_mulhi_epi16(noiseLanes, noiseFactor));
+            v = _mm512_min_epi16(_mm512_max_epi16(v, zero), one);
+        }
+        if (row.invert) {
+            v = _mm512_sub_epi16(one, v);
+        }
+
+        // Every lane is 0..255 by now, so truncating to bytes is exact
+        __m256i result = _mm512_cvtepi16_epi8(toByte(_mm512_min_epi16(_mm512_max_epi16(v, zero), one)));
+        result = _mm256_blendv_epi8(result, bytes, alphaBytes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), result);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row.noiseState), noiseState);
+}
+
+const SimdKernels avx512 = {mixRows, blockSad, boxRow, expandPalette, fixedPointRow};
+
+} // end anonymous namespace
+
+const SimdKernels* avx512Kernels() {
+    return &avx512;
+}
+
+#else
+
+const SimdKernels* avx512Kernels() {
+    return nullptr;
+}
+
+#endif
@@ -1,11 +1,13 @@
 #include "plugin.hpp"
 #include "GIFGlitcher.hpp"
+#include "SimdKernels.hpp"
 
 Plugin* pluginInstance;
 Model* modelGIFGlitcher;
 
 void init(Plugin* p) {
 	pluginInstance = p;
+	selectSimdKernels();
 
 	modelGIFGlitcher = createModel<GIFGlitcher, GIFGlitcherWidget>("GIFGlitcher");
 	
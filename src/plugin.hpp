@@ -4,4 +4,4 @@
 using namespace rack;
 
 extern Plugin* pluginInstance;
-extern Model* modelImageGlitcher;
+extern Model* modelGIFGlitcher;
@@ -0,0 +1,305 @@
+#pragma once
+// Synthetic GIF corpus for the decoder tools. Every file is generated here
+// with a small LZW encoder, so the corpus is the same on every machine and
+// nothing binary lives in the tree. It covers 1 to 8 bits per pixel, odd
+// sizes, interlacing, sub-rectangle frames, clear codes sent on a period
+// and tables left full (deferred clear). Damaged copies exercise the error
+// paths.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "gif_lib.h"
+
+namespace gifcorpus {
+
+struct File {
+    std::string name;
+    std::vector<unsigned char> bytes;
+};
+
+// xorshift64*, seeded per file
+struct Random {
+    uint64_t state;
+    explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+struct LzwOptions {
+    int clearEvery{0};     // Send a clear code every so many codes, 0 never
+    bool deferClear{false};  // Keep a full table instead of clearing it
+};
+
+// GIF image data: minimum code size then the LZW codes in sub-blocks
+inline void encodeLzw(const std::vector<uint8_t>& indices, int minCodeSize, LzwOptions options, std::vector<unsigned char>& out) {
+    const int clear = 1 << minCodeSize;
+    const int eoi = clear + 1;
+    std::vector<unsigned char> data;
+    uint32_t buffer = 0;
+    int bits = 0;
+    auto emit = [&](int code, int size) {
+        buffer |= static_cast<uint32_t>(code) << bits;
+        bits += size;
+        while (bits >= 8) {
+            data.push_back(static_cast<unsigned char>(buffer & 0xFF));
+            buffer >>= 8;
+            bits -= 8;
+        }
+    };
+
+    // Dictionary as (prefix code, pixel) -> code. An entry only counts if
+    // it was added since the last clear, so a clear does not touch the table.
+    std::vector<int> table(4096 * 256);
+    std::vector<uint32_t> added(4096 * 256, 0);
+    uint32_t epoch = 0;
+    int nextCode = 0;
+    int size = 0;
+    auto reset = [&]() {
+        epoch++;
+        nextCode = eoi + 1;
+        size = minCodeSize + 1;
+    };
+    reset();
+    emit(clear, size);
+
+    int current = -1;
+    int count = 0;
+    for (uint8_t index : indices) {
+        if (current < 0) {
+            current = index;
+            continue;
+        }
+        size_t key = static_cast<size_t>(current) * 256 + index;
+        if (added[key] == epoch) {
+            current = table[key];
+            continue;
+        }
+        emit(current, size);
+        count++;
+        if (nextCode < 4096) {
+            table[key] = nextCode++;
+            added[key] = epoch;
+            if (nextCode > (1 << size) && size < 12) size++;
+        } else if (!options.deferClear) {
+            emit(clear, size);
+            reset();
+        }
+        if (options.clearEvery > 0 && count % options.clearEvery == 0 && nextCode < 4096) {
+            emit(clear, size);
+            reset();
+        }
+        current = index;
+    }
+    if (current >= 0) emit(current, size);
+    emit(eoi, size);
+    if (bits > 0) data.push_back(static_cast<unsigned char>(buffer & 0xFF));
+
+    out.push_back(static_cast<unsigned char>(minCodeSize));
+    for (size_t i = 0; i < data.size(); i += 255) {
+        size_t chunk = std::min<size_t>(255, data.size() - i);
+        out.push_back(static_cast<unsigned char>(chunk));
+        out.insert(out.end(), data.begin() + i, data.begin() + i + chunk);
+    }
+    out.push_back(0);
+}
+
+enum Pattern { FLAT, NOISE, RUNS, MIXED };
+
+inline void put16(std::vector<unsigned char>& out, int value) {
+    out.push_back(static_cast<unsigned char>(value & 0xFF));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+inline File makeGif(const std::string& name, int width, int height, int frames, int bpp, Pattern pattern,
+                    bool interlace, LzwOptions options, uint64_t seed) {
+    Random random(seed);
+    const int colors = 1 << bpp;
+    const int minCodeSize = std::max(2, bpp);
+
+    File file{name, {}};
+    std::vector<unsigned char>& out = file.bytes;
+    for (const char* signature = "GIF89a"; *signature; signature++) {
+        out.push_back(static_cast<unsigned char>(*signature));
+    }
+    put16(out, width);
+    put16(out, height);
+    out.push_back(static_cast<unsigned char>(0x80 | (bpp - 1)));
+    out.push_back(0);
+    out.push_back(0);
+    for (int i = 0; i < colors * 3; i++) {
+        out.push_back(static_cast<unsigned char>(random.below(256)));
+    }
+    static const unsigned char loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+    out.insert(out.end(), loop, loop + sizeof(loop));
+
+    std::vector<uint8_t> pixels;
+    for (int f = 0; f < frames; f++) {
+        int frameWidth = width, frameHeight = height, left = 0, top = 0;
+        if (f > 0 && pattern != NOISE) {
+            frameWidth = std::max(1, width / 2);
+            frameHeight = std::max(1, height / 2);
+            left = random.below(width - frameWidth + 1);
+            top = random.below(height - frameHeight + 1);
+        }
+        // Graphic control: random disposal, 50 ms, transparent index
+        out.push_back(0x21);
+        out.push_back(0xF9);
+        out.push_back(0x04);
+        out.push_back(static_cast<unsigned char>((random.below(4) << 2) | 1));
+        put16(out, 5);
+        out.push_back(static_cast<unsigned char>(random.below(colors)));
+        out.push_back(0);
+
+        out.push_back(0x2C);
+        put16(out, left);
+        put16(out, top);
+        put16(out, frameWidth);
+        put16(out, frameHeight);
+        out.push_back(interlace ? 0x40 : 0);
+
+        pixels.clear();
+        for (int y = 0; y < frameHeight; y++) {
+            for (int x = 0; x < frameWidth; x++) {
+                int value;
+                switch (pattern) {
+                    case NOISE: value = random.below(colors); break;
+                    case FLAT: value = f + x / 97; break;
+                    case RUNS: value = (x + f * 3) / (1 + y % 17); break;
+                    default: value = random.below(50) == 0 ? random.below(colors) : (x * x + y * 3 + f) >> 4; break;
+                }
+                pixels.push_back(static_cast<uint8_t>(value % colors));
+            }
+        }
+        if (interlace) {
+            // Rows in the four interlace passes
+            std::vector<uint8_t> ordered;
+            static const int starts[] = {0, 4, 2, 1};
+            static const int steps[] = {8, 8, 4, 2};
+            for (int pass = 0; pass < 4; pass++) {
+                for (int y = starts[pass]; y < frameHeight; y += steps[pass]) {
+                    ordered.insert(ordered.end(), pixels.begin() + static_cast<size_t>(y) * frameWidth,
+                                   pixels.begin() + static_cast<size_t>(y + 1) * frameWidth);
+                }
+            }
+            pixels.swap(ordered);
+        }
+        encodeLzw(pixels, minCodeSize, options, out);
+    }
+    out.push_back(0x3B);
+    return file;
+}
+
+// The well formed corpus: every size and pattern plain, interlaced, with a
+// deferred clear and with periodic clears
+inline std::vector<File> makeCorpus() {
+    struct Spec {
+        const char* name;
+        int width, height, frames, bpp;
+        Pattern pattern;
+    };
+    static const Spec specs[] = {
+        {"tiny_1bpp", 7, 5, 3, 1, MIXED},
+        {"flat_8bpp", 640, 360, 6, 8, FLAT},
+        {"noise_8bpp", 320, 240, 4, 8, NOISE},
+        {"runs_4bpp", 500, 301, 5, 4, RUNS},
+        {"mixed_2bpp", 257, 129, 8, 2, MIXED},
+        {"mixed_8bpp_big", 1280, 720, 10, 8, MIXED},
+        {"runs_8bpp_big", 1920, 1080, 6, 8, RUNS},
+        {"flat_3bpp", 1000, 1000, 3, 3, FLAT},
+    };
+    std::vector<File> files;
+    for (const Spec& spec : specs) {
+        std::string name = spec.name;
+        files.push_back(makeGif(name, spec.width, spec.height, spec.frames, spec.bpp, spec.pattern, false, {}, 0));
+        files.push_back(makeGif(name + "_il", spec.width, spec.height, spec.frames, spec.bpp, spec.pattern, true, {}, 1));
+        files.push_back(makeGif(name + "_defer", spec.width, spec.height, spec.frames, spec.bpp, spec.pattern, false, {0, true}, 2));
+        files.push_back(makeGif(name + "_clr", spec.width, spec.height, spec.frames, spec.bpp, spec.pattern, false, {333, false}, 3));
+    }
+    return files;
+}
+
+// Damaged copies of the smaller corpus files: a few bytes overwritten past
+// the screen descriptor, or the file cut short
+inline std::vector<File> makeDamaged(const std::vector<File>& corpus, int count) {
+    std::vector<const File*> bases;
+    for (const File& file : corpus) {
+        if (file.bytes.size() < 500000) bases.push_back(&file);
+    }
+    std::vector<File> files;
+    Random random(0xDA3A6E);
+    for (int i = 0; i < count; i++) {
+        const File& base = *bases[random.below(bases.size())];
+        char name[64];
+        std::snprintf(name, sizeof(name), "damaged_%03d_%s", i, base.name.c_str());
+        File file{name, base.bytes};
+        if (random.below(4) == 0) {
+            file.bytes.resize(13 + random.below(file.bytes.size() - 13));
+        } else {
+            int edits = 1 + random.below(8);
+            for (int e = 0; e < edits; e++) {
+                file.bytes[13 + random.below(file.bytes.size() - 13)] = static_cast<unsigned char>(random.below(256));
+            }
+        }
+        files.push_back(std::move(file));
+    }
+    return files;
+}
+
+// DGifOpen over a byte buffer
+struct MemoryInput {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+};
+
+inline int readMemory(GifFileType* gif, GifByteType* buffer, int length) {
+    MemoryInput* input = static_cast<MemoryInput*>(gif->UserData);
+    size_t count = std::min(input->size - input->position, static_cast<size_t>(length));
+    std::memcpy(buffer, input->data + input->position, count);
+    input->position += count;
+    return static_cast<int>(count);
+}
+
+struct Decoded {
+    int result{0};   // DGifSlurp's return, -1 if DGifOpen failed
+    int error{0};    // GIF error code
+    size_t pixels{0};
+    uint64_t hash{0xCBF29CE484222325ull};  // FNV-1a over every raster
+};
+
+// Slurps the file; the raster is hashed only when hash is set
+inline Decoded decode(const File& file, bool hash) {
+    Decoded decoded;
+    MemoryInput input{file.bytes.data(), file.bytes.size(), 0};
+    int error = 0;
+    GifFileType* gif = DGifOpen(&input, readMemory, &error);
+    if (!gif) {
+        decoded.result = -1;
+        decoded.error = error;
+        return decoded;
+    }
+    decoded.result = DGifSlurp(gif);
+    decoded.error = gif->Error;
+    for (int i = 0; i < gif->ImageCount; i++) {
+        const SavedImage& image = gif->SavedImages[i];
+        if (!image.RasterBits) continue;
+        size_t count = static_cast<size_t>(image.ImageDesc.Width) * image.ImageDesc.Height;
+        decoded.pixels += count;
+        if (!hash) continue;
+        for (size_t j = 0; j < count; j++) {
+            decoded.hash = (decoded.hash ^ image.RasterBits[j]) * 0x100000001B3ull;
+        }
+    }
+    DGifCloseFile(gif, &error);
+    return decoded;
+}
+
+} // namespace gifcorpus
@@ -0,0 +1,189 @@
+// Tolerance test of FixedPointPipeline against the float path it replaces.
+// Random images go through random params limited to the stages fixed point
+// has (no noise, whose random numbers differ between the paths), once on
+// the float rows and once on the fixed point rows of a scratch module, and
+// the per value differences are checked against the thresholds below:
+//  - trials with only mirror, flip, color, interlace and invert differ by
+//    rounding alone
+//  - trials that also posterize, dither or bit crush may flip a level on a
+//    rounding edge, and the float bit crush wraps colors pushed below 0
+//    where fixed point saturates; those count as outliers
+// The fixed point frame, with noise added half the time, must also come out
+// bit for bit the same on the AVX2 and AVX-512 rows as on SSE2; the odd
+// width leaves them a short last step. Exits non-zero if a threshold is
+// crossed or a level differs. Built like render-verify.
+//
+//   fixed-point-tolerance [trials]
+#include "GIFGlitcher.hpp"
+#include "SimdKernels.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+// The plugin's globals live in plugin.cpp, which is left out
+Plugin* pluginInstance;
+Model* modelGIFGlitcher;
+
+namespace {
+
+constexpr int WIDTH = 67;  // Odd, so the two pixel SSE2 loop runs its tail
+constexpr int HEIGHT = 41;
+
+// Measured over the default 3000 trials and over 30000: rounding alone is
+// exact on 78% of the values and within 1 on 97.6%, but contrast and
+// saturation can scale an 8.8 rounding error up to 5 (mean 0.25)
+constexpr int ROUNDING_MAX_ERROR = 6;
+constexpr double ROUNDING_MIN_WITHIN_ONE = 0.97;
+constexpr double ROUNDING_MAX_MEAN = 0.3;
+// With levels, 97% of the values are within 1, 0.55% to 0.62% are more
+// than 16 off and the mean error is 0.86 to 0.97
+constexpr double LEVELS_MIN_WITHIN_ONE = 0.96;
+constexpr int LEVELS_OUTLIER_ERROR = 16;
+constexpr double LEVELS_MAX_OUTLIERS = 0.01;  // Share of values over LEVELS_OUTLIER_ERROR
+constexpr double LEVELS_MAX_MEAN = 1.5;
+
+// xorshift64*, so the trials are the same on every machine
+struct Random {
+    uint64_t state;
+    explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+    bool chance(int n) { return next() % n == 0; }
+};
+
+struct Errors {
+    size_t values{0};
+    size_t histogram[256] = {};
+    int maxError{0};
+    double total{0.0};
+
+    void add(int error) {
+        values++;
+        histogram[error]++;
+        maxError = std::max(maxError, error);
+        total += error;
+    }
+    double shareAtMost(int error) const {
+        size_t count = 0;
+        for (int i = 0; i <= error; i++) count += histogram[i];
+        return values > 0 ? static_cast<double>(count) / values : 1.0;
+    }
+    double mean() const { return values > 0 ? total / values : 0.0; }
+    void print(const char* name) const {
+        std::printf("%s: %zu values, exact %.3f%%, within 1 %.3f%%, over %d %.4f%%, max %d, mean %.4f\n", name, values,
+                    shareAtMost(0) * 100.0, shareAtMost(1) * 100.0, LEVELS_OUTLIER_ERROR,
+                    (1.0 - shareAtMost(LEVELS_OUTLIER_ERROR)) * 100.0, maxError, mean());
+    }
+};
+
+} // end anonymous namespace
+
+struct FixedPointTolerance {
+    // Frame of module rendered with params, on the path params.fixedPoint picks
+    static std::vector<unsigned char> render(GIFGlitcher& module, const unsigned char* source, const ProcessingParams& params) {
+        module.renderParams = params;
+        std::vector<unsigned char> output;
+        module.renderFrame(source, 0, output, 0, false);
+        return output;
+    }
+
+    static int run(int trials) {
+        Random random(0xF1ED);
+        GIFGlitcher module;
+        module.imageWidth = WIDTH;
+        module.imageHeight = HEIGHT;
+
+        std::vector<unsigned char> source(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+        Errors rounding;
+        Errors levels;
+        int simdMismatches = 0;
+        for (int trial = 0; trial < trials; trial++) {
+            for (size_t i = 0; i < source.size(); i++) {
+                source[i] = static_cast<unsigned char>(random.next());
+            }
+            // A quarter grey, where saturation and hue do nothing
+            for (size_t i = 0; i < source.size() / 16; i++) {
+                source[i * 4 + 1] = source[i * 4 + 2] = source[i * 4];
+            }
+
+            ProcessingParams params;
+            params.brightness = random.chance(5) ? 1.0f : random.uniform() * 2.0f;
+            params.contrast = random.chance(5) ? 1.0f : random.uniform() * 2.0f;
+            params.saturation = random.chance(3) ? 1.0f : random.uniform() * 2.0f;
+            params.mirrorEffect = random.chance(8);
+            params.halfMirrorEffect = !params.mirrorEffect && random.chance(7);
+            params.flipEffect = random.chance(8);
+            params.halfMirrorVerticalEffect = !params.flipEffect && random.chance(7);
+            params.interlaceEffect = random.chance(4);
+            params.interlaceIntensity = random.uniform();
+            params.invertColors = random.chance(4);
+            bool withLevels = !random.chance(3);
+            if (withLevels) {
+                params.posterize = random.chance(2) ? random.uniform() : 0.0f;
+                params.ditherEffect = random.chance(3);
+                params.ditherIntensity = random.uniform();
+                params.bitCrush = random.chance(3) ? random.uniform() : 0.0f;
+            }
+
+            ProcessingParams fixedParams = params;
+            fixedParams.fixedPoint = true;
+            if (!FixedPointPipeline::supports(fixedParams)) {
+                std::printf("trial %d: fixed point does not support the params\n", trial);
+                return 1;
+            }
+            module.renderClock = (trial % 2) / 60.0f;
+            std::vector<unsigned char> floatFrame = render(module, source.data(), params);
+            std::vector<unsigned char> fixedFrame = render(module, source.data(), fixedParams);
+
+            Errors& errors = withLevels ? levels : rounding;
+            for (size_t i = 0; i < floatFrame.size(); i++) {
+                errors.add(std::abs(floatFrame[i] - fixedFrame[i]));
+            }
+
+            if (random.chance(2)) {
+                fixedParams.noise = random.uniform();
+            }
+            random::local().seed(trial, 1);
+            std::vector<unsigned char> sse2Frame = render(module, source.data(), fixedParams);
+            for (SimdLevel level : {SIMD_AVX2, SIMD_AVX512}) {
+                if (!useSimdLevel(level)) continue;
+                random::local().seed(trial, 1);
+                if (render(module, source.data(), fixedParams) != sse2Frame) {
+                    std::printf("trial %d: fixed point rows differ on %s\n", trial, simdLevelName(level));
+                    simdMismatches++;
+                }
+            }
+            useSimdLevel(SIMD_SSE2);
+        }
+
+        rounding.print("rounding");
+        levels.print("levels");
+
+        int failures = 0;
+        auto check = [&](bool passed, const char* what) {
+            if (!passed) {
+                std::printf("FAIL %s\n", what);
+                failures++;
+            }
+        };
+        check(rounding.maxError <= ROUNDING_MAX_ERROR, "rounding trials off by more than ROUNDING_MAX_ERROR");
+        check(rounding.shareAtMost(1) >= ROUNDING_MIN_WITHIN_ONE, "rounding trials within 1 below ROUNDING_MIN_WITHIN_ONE");
+        check(rounding.mean() <= ROUNDING_MAX_MEAN, "rounding trials mean error over ROUNDING_MAX_MEAN");
+        check(levels.shareAtMost(1) >= LEVELS_MIN_WITHIN_ONE, "levels trials within 1 below LEVELS_MIN_WITHIN_ONE");
+        check(1.0 - levels.shareAtMost(LEVELS_OUTLIER_ERROR) <= LEVELS_MAX_OUTLIERS, "levels trials over LEVELS_MAX_OUTLIERS");
+        check(levels.mean() <= LEVELS_MAX_MEAN, "levels trials mean error over LEVELS_MAX_MEAN");
+        check(simdMismatches == 0, "fixed point rows differ between instruction sets");
+        std::printf("%d trials, %d failures\n", trials, failures);
+        return failures == 0 ? 0 : 1;
+    }
+};
+
+int main(int argc, char** argv) {
+    int trials = argc > 1 ? std::atoi(argv[1]) : 3000;
+    return FixedPointTolerance::run(std::max(trials, 1));
+}
@@ -0,0 +1,91 @@
+// Synthetic live source for GIFGlitcher's "Shared Memory Source": publishes
+// moving color bars with a sweeping bar and a frame counter strip to a
+// FrameRing segment at a fixed rate until interrupted.
+//
+//   frame-ring-producer [name [width height fps]]
+//
+// Defaults to /frame-ring-producer, 640x360 at 30 fps.
+#include "FrameRing.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+namespace {
+
+volatile std::sig_atomic_t running = 1;
+
+void stop(int) {
+    running = 0;
+}
+
+void drawFrame(std::vector<unsigned char>& pixels, int width, int height, uint64_t frame) {
+    static const unsigned char BARS[8][3] = {
+        {255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+        {255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {0, 0, 0}
+    };
+    int barX = static_cast<int>(frame * 4 % width);
+    int counterTop = height - height / 8;
+    for (int y = 0; y < height; y++) {
+        unsigned char* row = &pixels[static_cast<size_t>(y) * width * 4];
+        for (int x = 0; x < width; x++) {
+            unsigned char* pixel = row + x * 4;
+            if (y >= counterTop) {
+                // Frame number in binary, one block per bit, so skipped
+                // frames show on screen
+                int bit = x * 32 / width;
+                unsigned char value = (frame >> (31 - bit)) & 1 ? 255 : 32;
+                pixel[0] = pixel[1] = pixel[2] = value;
+            } else {
+                const unsigned char* bar = BARS[((x + static_cast<int>(frame)) * 8 / width) % 8];
+                unsigned char shade = static_cast<unsigned char>(64 + 191 * y / height);
+                pixel[0] = static_cast<unsigned char>(bar[0] * shade / 255);
+                pixel[1] = static_cast<unsigned char>(bar[1] * shade / 255);
+                pixel[2] = static_cast<unsigned char>(bar[2] * shade / 255);
+                if (std::abs(x - barX) < 4) {
+                    pixel[0] = pixel[1] = pixel[2] = 255;
+                }
+            }
+            pixel[3] = 255;
+        }
+    }
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    std::string name = argc > 1 ? argv[1] : "/frame-ring-producer";
+    int width = argc > 4 ? std::atoi(argv[2]) : 640;
+    int height = argc > 4 ? std::atoi(argv[3]) : 360;
+    double fps = argc > 4 ? std::atof(argv[4]) : 30.0;
+    if (width <= 0 || height <= 0 || fps <= 0.0) {
+        std::fprintf(stderr, "usage: %s [name [width height fps]]\n", argv[0]);
+        return 1;
+    }
+
+    FrameRingWriter writer;
+    if (!writer.open(name, width, height)) {
+        std::fprintf(stderr, "cannot create %s\n", name.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::printf("publishing %dx%d at %.1f fps to %s, Ctrl-C to stop\n", width, height, fps, name.c_str());
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    auto next = std::chrono::steady_clock::now();
+    while (running) {
+        drawFrame(pixels, width, height, writer.getSequence() + 1);
+        writer.publish(pixels.data(), width, height);
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    // Unlinks the segment; attached readers see it closed
+    writer.close();
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Attaches to a GIFGlitcher shared memory output and prints, once a second,
+// how many frames arrived, how many were skipped or torn, the bandwidth and
+// the latency from publish to read. Optionally saves the newest frame.
+//
+//   frame-ring-reader /gifglitcher-<module id> [frame.ppm]
+#include "FrameRing.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+namespace {
+
+bool savePpm(const std::string& path, const std::vector<unsigned char>& rgba, int width, int height) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        std::fwrite(&rgba[i], 1, 3, file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <segment name> [frame.ppm]\n", argv[0]);
+        return 1;
+    }
+    std::string name = argv[1];
+    std::string ppmPath = argc > 2 ? argv[2] : "";
+
+    FrameRingReader reader;
+    uint64_t last = 0;
+    uint64_t frames = 0, skipped = 0, torn = 0, bytes = 0;
+    double latencyMs = 0.0;
+    std::vector<unsigned char> copy;
+    auto reportTime = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    while (true) {
+        if (!reader.isOpen() || reader.isClosed()) {
+            // Not there yet, or the writer moved to a larger segment
+            if (!reader.open(name)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                continue;
+            }
+            std::printf("attached to %s\n", name.c_str());
+            last = 0;
+        }
+
+        if (reader.wait(last, 100)) {
+            FrameRingReader::Frame frame;
+            if (reader.latest(frame) && frame.sequence > last) {
+                // Copied out, as a consumer that keeps the frame would
+                copy.assign(frame.pixels, frame.pixels + static_cast<size_t>(frame.width) * frame.height * 4);
+                if (!reader.isIntact(frame)) {
+                    torn++;
+                } else {
+                    if (last != 0) skipped += frame.sequence - last - 1;
+                    frames++;
+                    bytes += copy.size();
+                    latencyMs += (frameRingNow() - frame.timestampNs) / 1e6;
+                    if (!ppmPath.empty()) savePpm(ppmPath, copy, frame.width, frame.height);
+                }
+                last = frame.sequence;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= reportTime) {
+            std::printf("%llu frames/s, %llu skipped, %llu torn, %.1f MB/s, %.2f ms latency\n",
+                        (unsigned long long) frames, (unsigned long long) skipped, (unsigned long long) torn,
+                        bytes / 1e6, frames ? latencyMs / frames : 0.0);
+            std::fflush(stdout);
+            frames = skipped = torn = bytes = 0;
+            latencyMs = 0.0;
+            reportTime = now + std::chrono::seconds(1);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// Throughput test for FrameRing: a writer process publishes frames as fast
+// as it can while a forked reader process waits on the futex, reads every
+// newest frame in place and checks it. Exits non-zero if a frame passed as
+// intact had wrong pixels, or if nothing arrived.
+//
+//   frame-ring-throughput [width height seconds]
+#include "FrameRing.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Every byte of frame n is derived from n, so a mix of two frames shows
+unsigned char pattern(uint64_t sequence, size_t i) {
+    return static_cast<unsigned char>(sequence * 131 + (i >> 12));
+}
+
+int runReader(const std::string& name, double seconds) {
+    FrameRingReader reader;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds + 2.0);
+    while (!reader.open(name)) {
+        if (std::chrono::steady_clock::now() > deadline) return 2;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint64_t last = 0, frames = 0, skipped = 0, torn = 0, corrupt = 0;
+    std::vector<double> latencies;
+    while (!reader.isClosed()) {
+        if (!reader.wait(last, 100)) continue;
+        FrameRingReader::Frame frame;
+        if (!reader.latest(frame) || frame.sequence <= last) continue;
+
+        size_t size = static_cast<size_t>(frame.width) * frame.height * 4;
+        bool matches = true;
+        // Strided check, so the test measures the ring rather than the check
+        for (size_t i = 0; i < size; i += 61) {
+            matches = matches && frame.pixels[i] == pattern(frame.sequence, i);
+        }
+        if (!reader.isIntact(frame)) {
+            torn++;
+        } else {
+            if (!matches) corrupt++;
+            if (last != 0) skipped += frame.sequence - last - 1;
+            frames++;
+            latencies.push_back((frameRingNow() - frame.timestampNs) / 1e3);
+        }
+        last = frame.sequence;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double median = latencies.empty() ? 0.0 : latencies[latencies.size() / 2];
+    double worst = latencies.empty() ? 0.0 : latencies[latencies.size() * 99 / 100];
+    std::printf("reader: %llu frames read, %llu skipped, %llu torn, %llu corrupt, latency median %.1f us, p99 %.1f us\n",
+                (unsigned long long) frames, (unsigned long long) skipped, (unsigned long long) torn,
+                (unsigned long long) corrupt, median, worst);
+    std::fflush(stdout);
+    return (corrupt == 0 && frames > 0) ? 0 : 1;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    int width = argc > 3 ? std::atoi(argv[1]) : 1280;
+    int height = argc > 3 ? std::atoi(argv[2]) : 720;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 3.0;
+    std::string name = "/frame-ring-throughput-" + std::to_string(getpid());
+
+    FrameRingWriter writer;
+    if (!writer.open(name, width, height)) {
+        std::fprintf(stderr, "cannot create %s\n", name.c_str());
+        return 1;
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        // _exit: the writer copy in this process must not close the segment
+        _exit(runReader(name, seconds));
+    }
+
+    std::vector<std::vector<unsigned char>> sources(4, std::vector<unsigned char>(static_cast<size_t>(width) * height * 4));
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration<double>(seconds);
+    uint64_t published = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        // Source contents for the sequence the frame is about to get
+        uint64_t next = writer.getSequence() + 1;
+        std::vector<unsigned char>& source = sources[next % sources.size()];
+        for (size_t i = 0; i < source.size(); i += 61) {
+            source[i] = pattern(next, i);
+        }
+        writer.publish(source.data(), width, height);
+        published++;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    writer.close();
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    double bytes = static_cast<double>(published) * width * height * 4;
+    std::printf("writer: %dx%d, %llu frames in %.2f s, %.0f frames/s, %.2f GB/s\n",
+                width, height, (unsigned long long) published, elapsed, published / elapsed, bytes / elapsed / 1e9);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,65 @@
+// Decode throughput of the vendored GIF decoder, in megabytes of raster
+// (one byte per pixel) per second. Each file is decoded from memory with
+// DGifOpen and DGifSlurp; the best of several runs counts.
+//
+//   gif-decode-bench [runs [file.gif ...]]
+//
+// Without files it times the synthetic corpus of gif-decode-check. To
+// compare with another giflib, build against it:
+//   make -C tools clean gif-decode-bench GIFLIB=/path/to/giflib
+#include "GifCorpus.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+double bestSeconds(const gifcorpus::File& file, int runs, size_t& pixels) {
+    double best = 1e30;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        gifcorpus::Decoded decoded = gifcorpus::decode(file, false);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds);
+        pixels = decoded.pixels;
+    }
+    return best;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    int runs = argc > 1 ? std::atoi(argv[1]) : 7;
+    if (runs <= 0) {
+        std::fprintf(stderr, "usage: %s [runs [file.gif ...]]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<gifcorpus::File> files;
+    for (int i = 2; i < argc; i++) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        files.push_back({argv[i], std::vector<unsigned char>(std::istreambuf_iterator<char>(in), {})});
+    }
+    if (files.empty()) {
+        files = gifcorpus::makeCorpus();
+    }
+
+    double totalBytes = 0.0, totalSeconds = 0.0;
+    for (const gifcorpus::File& file : files) {
+        size_t pixels = 0;
+        double seconds = bestSeconds(file, runs, pixels);
+        totalBytes += pixels;
+        totalSeconds += seconds;
+        std::printf("%-28s %10zu px %9.3f ms %8.1f MB/s\n", file.name.c_str(), pixels, seconds * 1e3,
+                    seconds > 0.0 ? pixels / seconds / 1e6 : 0.0);
+    }
+    std::printf("total %.1f MB in %.3f s, %.1f MB/s\n", totalBytes / 1e6, totalSeconds,
+                totalSeconds > 0.0 ? totalBytes / totalSeconds / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Checks the vendored GIF decoder against recorded output: every file of the
+// synthetic corpus (see GifCorpus.hpp) and damaged copies of them are
+// slurped, and DGifSlurp's result, the error code, the pixel count and, for
+// files that decode, a hash of every raster must match
+// gif-decode-golden.txt. The golden file was recorded with the decoder as
+// it was before the table-driven LZW path, so a pass means the same bytes
+// and the same errors as that decoder.
+//
+//   gif-decode-check [golden]           compare, exits non-zero on a mismatch
+//   gif-decode-check --record [golden]  write the golden file
+#include "GifCorpus.hpp"
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace {
+
+constexpr int DAMAGED_FILES = 400;
+
+std::string describe(const gifcorpus::Decoded& decoded) {
+    char text[96];
+    if (decoded.result != GIF_OK) {
+        // A failed slurp leaves the rest of the raster it was decoding
+        // uninitialized, so only the failure itself is comparable
+        std::snprintf(text, sizeof(text), "%d %d %zu -", decoded.result, decoded.error, decoded.pixels);
+    } else {
+        std::snprintf(text, sizeof(text), "%d %d %zu %016llx", decoded.result, decoded.error, decoded.pixels,
+                      static_cast<unsigned long long>(decoded.hash));
+    }
+    return text;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+    bool record = argc > 1 && std::strcmp(argv[1], "--record") == 0;
+    int pathArgument = record ? 2 : 1;
+    std::string golden = argc > pathArgument ? argv[pathArgument] : "gif-decode-golden.txt";
+
+    std::vector<gifcorpus::File> files = gifcorpus::makeCorpus();
+    std::vector<gifcorpus::File> damaged = gifcorpus::makeDamaged(files, DAMAGED_FILES);
+    files.insert(files.end(), damaged.begin(), damaged.end());
+
+    if (record) {
+        FILE* out = std::fopen(golden.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", golden.c_str());
+            return 1;
+        }
+        std::fprintf(out, "# name result error pixels hash\n");
+        for (const gifcorpus::File& file : files) {
+            std::fprintf(out, "%s %s\n", file.name.c_str(), describe(gifcorpus::decode(file, true)).c_str());
+        }
+        std::fclose(out);
+        std::printf("recorded %zu files to %s\n", files.size(), golden.c_str());
+        return 0;
+    }
+
+    std::map<std::string, std::string> expected;
+    FILE* in = std::fopen(golden.c_str(), "r");
+    if (!in) {
+        std::fprintf(stderr, "cannot read %s\n", golden.c_str());
+        return 1;
+    }
+    char line[256];
+    while (std::fgets(line, sizeof(line), in)) {
+        if (line[0] == '#') continue;
+        line[std::strcspn(line, "\n")] = 0;
+        char* space = std::strchr(line, ' ');
+        if (!space) continue;
+        expected[std::string(line, space)] = space + 1;
+    }
+    std::fclose(in);
+
+    int mismatches = 0;
+    for (const gifcorpus::File& file : files) {
+        std::string result = describe(gifcorpus::decode(file, true));
+        auto it = expected.find(file.name);
+        if (it == expected.end() || it->second != result) {
+            std::printf("MISMATCH %s: got %s, expected %s\n", file.name.c_str(), result.c_str(),
+                        it == expected.end() ? "nothing" : it->second.c_str());
+            mismatches++;
+        }
+    }
+    std::printf("%zu files, %d mismatches\n", files.size(), mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
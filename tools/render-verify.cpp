@@ -0,0 +1,475 @@
+// Checks the optimized render paths against the reference path, so the
+// pipeline can get faster without changing what it draws. The plugin's
+// render code is linked against libRack from the SDK and runs here, outside
+// Rack: a fixed corpus of synthetic stills and one animation goes through
+// a matrix of ProcessingParams presets, with the random source seeded
+// before every frame. Each case renders on the reference path (float rows,
+// SSE2 kernels, every parallelFor on one thread), its hash is checked
+// against render-golden.txt, and then it renders again on
+//  - the render threads, with parallelFor splitting tiles, bit for bit
+//  - the pre-render path, bit for bit (presets with frame history must be
+//    refused instead)
+//  - AVX2 and AVX-512 kernels, bit for bit
+//  - scanline groups that all hold the frame's values, bit for bit
+//  - fixed point rows, within a per channel tolerance, and fixed point
+//    rows on AVX2 and AVX-512 against SSE2, bit for bit
+//
+// Float results can differ between compilers, flags and CPUs: record the
+// golden file with a build known to be right before changing the pipeline.
+//
+//   render-verify [golden]           compare, exits non-zero on a failure
+//   render-verify --record [golden]  write the golden file
+#include "GIFGlitcher.hpp"
+#include "RenderScheduler.hpp"
+#include "SimdKernels.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <algorithm>
+
+// The plugin's globals live in plugin.cpp, which is left out
+Plugin* pluginInstance;
+Model* modelGIFGlitcher;
+
+struct RenderVerifier {
+    struct Corpus;
+    using Frames = std::vector<std::vector<unsigned char>>;
+
+    // True when every case passed
+    static bool run(bool record, const std::string& golden);
+
+private:
+    // Every frame of a fresh module rendering corpus with params
+    static Frames render(const Corpus& corpus, const ProcessingParams& params);
+    // The same frames, each rendered ahead by prerenderNextFrame() and shown
+    // by takePrerenderedFrame(). Empty if the module refused to pre-render.
+    static Frames prerender(const Corpus& corpus, const ProcessingParams& params);
+};
+
+namespace {
+
+using Frames = RenderVerifier::Frames;
+
+// Renders per case; enough for feedback and motion mosh to build up
+constexpr size_t RENDERS = 4;
+constexpr uint64_t SEED = 0x5EED5EED5EED5EEDull;
+
+// Fixed point rounds every stage to 8.8. Measured on this corpus, rounding
+// alone stays within 1 per value, 5 once blur has summed it. Past that are
+// levels picked by posterize, bit crush or dither that flip on a rounding
+// edge (19 to 45 off), and colors pushed below 0 that the float bit crush
+// wraps round while fixed point saturates (255 off): at most 0.99% of the
+// values of a case, with a mean error of at most 1.21.
+constexpr int FIXED_POINT_MAX_ERROR = 5;
+constexpr double FIXED_POINT_MAX_OUTLIERS = 0.015;  // Share of values over FIXED_POINT_MAX_ERROR
+constexpr double FIXED_POINT_MAX_MEAN = 1.5;
+
+struct Preset {
+    const char* name;
+    void (*set)(ProcessingParams& params);
+};
+
+const Preset PRESETS[] = {
+    {"identity", [](ProcessingParams&) {}},
+    {"color", [](ProcessingParams& p) {
+        p.brightness = 1.3f;
+        p.contrast = 1.2f;
+        p.saturation = 0.6f;
+        p.hueShift = 0.25f;
+    }},
+    {"integer", [](ProcessingParams& p) {
+        // Only stages FixedPointPipeline has
+        p.brightness = 1.1f;
+        p.contrast = 0.9f;
+        p.saturation = 1.4f;
+        p.mirrorEffect = true;
+        p.ditherEffect = true;
+        p.ditherIntensity = 0.4f;
+        p.posterize = 0.3f;
+        p.bitCrush = 0.4f;
+        p.interlaceEffect = true;
+        p.invertColors = true;
+    }},
+    {"noise", [](ProcessingParams& p) {
+        p.noise = 0.5f;
+        p.flipEffect = true;
+    }},
+    {"glitch", [](ProcessingParams& p) {
+        p.glitchSlice = 0.5f;
+        p.glitchArtifacts = 1.0f;
+        p.glitchBlockSize = 2.0f;
+        p.glitchDisplacement = 0.5f;
+        p.rgbAberration = 0.3f;
+    }},
+    {"datamosh", [](ProcessingParams& p) {
+        p.bitCrush = 0.5f;
+        p.dataShift = 0.5f;
+        p.pixelSort = 0.5f;
+    }},
+    {"kernels", [](ProcessingParams& p) {
+        p.sharpness = 2.0f;
+        p.edgeDetect = 0.5f;
+        p.pixelation = 0.3f;
+        p.halfMirrorEffect = true;
+    }},
+    {"blur", [](ProcessingParams& p) {
+        p.blur = 0.5f;
+        p.bloom = 0.5f;
+        p.glow = 0.5f;
+    }},
+    {"feedback", [](ProcessingParams& p) {
+        p.feedback = 0.6f;
+        p.feedbackZoom = 0.3f;
+        p.feedbackDrift = 0.2f;
+    }},
+    {"motion", [](ProcessingParams& p) {
+        p.motionMosh = 0.7f;
+    }},
+    {"geometry", [](ProcessingParams& p) {
+        p.geometryMode = GeometryRemap::KALEIDOSCOPE;
+        p.geometryAmount = 0.5f;
+    }},
+    {"diffusion", [](ProcessingParams& p) {
+        p.diffusionMode = ErrorDiffusion::FLOYD_STEINBERG;
+        p.posterize = 0.3f;
+    }},
+};
+
+// FNV-1a over every rendered frame
+uint64_t hashFrames(const Frames& frames) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const auto& frame : frames) {
+        for (unsigned char value : frame) {
+            hash = (hash ^ value) * 0x100000001B3ull;
+        }
+    }
+    return hash;
+}
+
+std::string hashString(uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+struct Difference {
+    bool sameSize{true};
+    int maxError{0};
+    double meanError{0.0};
+    double outliers{0.0};  // Share of values over the threshold
+};
+
+Difference compare(const Frames& reference, const Frames& candidate, int threshold) {
+    Difference difference;
+    if (reference.size() != candidate.size()) {
+        difference.sameSize = false;
+        return difference;
+    }
+    size_t count = 0;
+    size_t over = 0;
+    double total = 0.0;
+    for (size_t f = 0; f < reference.size(); f++) {
+        if (reference[f].size() != candidate[f].size()) {
+            difference.sameSize = false;
+            return difference;
+        }
+        for (size_t i = 0; i < reference[f].size(); i++) {
+            int error = std::abs(reference[f][i] - candidate[f][i]);
+            difference.maxError = std::max(difference.maxError, error);
+            total += error;
+            over += error > threshold;
+        }
+        count += reference[f].size();
+    }
+    if (count > 0) {
+        difference.meanError = total / count;
+        difference.outliers = static_cast<double>(over) / count;
+    }
+    return difference;
+}
+
+} // end anonymous namespace
+
+struct RenderVerifier::Corpus {
+    const char* name;
+    // Source frames; the module also gets them as its GIF when animated,
+    // for motion mosh
+    std::shared_ptr<DecodedGif> frames;
+    bool animated;
+};
+
+namespace {
+
+// Integer patterns only, so the corpus is the same on every machine
+template <typename Pixel>
+RenderVerifier::Corpus makeCorpus(const char* name, int width, int height, int frameCount, Pixel pixel) {
+    auto gif = std::make_shared<DecodedGif>();
+    gif->width = width;
+    gif->height = height;
+    gif->storage.resize(gif->frameSize() * frameCount);
+    for (int f = 0; f < frameCount; f++) {
+        unsigned char* frame = gif->storage.data() + gif->frameSize() * f;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                unsigned char* rgba = frame + (static_cast<size_t>(y) * width + x) * 4;
+                pixel(x, y, f, rgba);
+                rgba[3] = 255;
+            }
+        }
+        gif->frames.push_back({frame, 40});
+    }
+    return {name, gif, frameCount > 1};
+}
+
+std::vector<RenderVerifier::Corpus> makeCorpora() {
+    std::vector<RenderVerifier::Corpus> corpora;
+    corpora.push_back(makeCorpus("gradient", 96, 64, 1, [](int x, int y, int, unsigned char* rgba) {
+        rgba[0] = static_cast<unsigned char>(x * 255 / 95);
+        rgba[1] = static_cast<unsigned char>(y * 255 / 63);
+        rgba[2] = static_cast<unsigned char>((x + y) * 255 / 158);
+    }));
+    // Odd size, so every vector loop runs its tail
+    corpora.push_back(makeCorpus("checker", 77, 45, 1, [](int x, int y, int, unsigned char* rgba) {
+        bool cell = ((x / 7) + (y / 5)) & 1;
+        rgba[0] = static_cast<unsigned char>(cell ? 230 : 20 + x);
+        rgba[1] = static_cast<unsigned char>(cell ? 40 + y * 3 : 200);
+        rgba[2] = static_cast<unsigned char>(x * y);
+    }));
+    corpora.push_back(makeCorpus("noise", 64, 48, 1, [](int x, int y, int, unsigned char* rgba) {
+        uint32_t state = static_cast<uint32_t>(y * 64 + x) * 2654435761u + 1;
+        for (int c = 0; c < 3; c++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            rgba[c] = static_cast<unsigned char>(state >> 24);
+        }
+    }));
+    // A square moving over a gradient, like a small GIF
+    corpora.push_back(makeCorpus("animation", 64, 48, 4, [](int x, int y, int f, unsigned char* rgba) {
+        bool square = x >= 10 + f * 5 && x < 22 + f * 5 && y >= 14 + f * 3 && y < 26 + f * 3;
+        rgba[0] = static_cast<unsigned char>(square ? 250 : x * 4);
+        rgba[1] = static_cast<unsigned char>(square ? 220 : y * 5);
+        rgba[2] = static_cast<unsigned char>(square ? 30 : 128);
+    }));
+    return corpora;
+}
+
+} // end anonymous namespace
+
+RenderVerifier::Frames RenderVerifier::render(const Corpus& corpus, const ProcessingParams& params) {
+    // Never added to an engine or scheduled; renderFrame runs right here
+    GIFGlitcher module;
+    module.imageWidth = corpus.frames->width;
+    module.imageHeight = corpus.frames->height;
+    if (corpus.animated) {
+        module.decodedGif = corpus.frames;
+    }
+    if (params.scanlines) {
+        // Enough history for a frame's worth of groups, all with the frame's values
+        for (int i = 0; i < 1024; i++) {
+            module.scanlineModulator.push(params, ScanlineModulation::CONTROL_RATE);
+        }
+        module.scanlineModulator.collect(RenderGovernor::DEFAULT_BUDGET);
+    }
+
+    Frames outputs;
+    for (size_t i = 0; i < RENDERS; i++) {
+        size_t frame = i % corpus.frames->frames.size();
+        random::local().seed(SEED, i + 1);
+        module.renderParams = params;
+        module.renderClock = i / 30.0f;
+        std::vector<unsigned char> output;
+        if (!module.renderFrame(corpus.frames->frames[frame].pixels, frame, output, 0, false)) {
+            return {};
+        }
+        outputs.push_back(std::move(output));
+    }
+    return outputs;
+}
+
+RenderVerifier::Frames RenderVerifier::prerender(const Corpus& corpus, const ProcessingParams& params) {
+    GIFGlitcher module;
+    module.imageWidth = corpus.frames->width;
+    module.imageHeight = corpus.frames->height;
+    module.decodedGif = corpus.frames;
+    module.gifFrames.assign(corpus.frames->frames.size(), {corpus.frames->frames[0].delay});
+    module.isAnimated = true;
+
+    Frames outputs;
+    size_t frameCount = corpus.frames->frames.size();
+    for (size_t i = 0; i < RENDERS; i++) {
+        // With the playhead one frame back, frame i is the next one up
+        size_t frame = i % frameCount;
+        module.currentFrame = (frame + frameCount - 1) % frameCount;
+        random::local().seed(SEED, i + 1);
+        module.renderParams = params;
+        module.renderClock = i / 30.0f;
+        if (!module.prerenderNextFrame(module.renderGeneration.load())) {
+            return {};
+        }
+        std::lock_guard<std::mutex> lock(module.bufferMutex);
+        if (!module.takePrerenderedFrame(frame)) {
+            return {};
+        }
+        outputs.push_back(*module.processedData);
+    }
+    return outputs;
+}
+
+bool RenderVerifier::run(bool record, const std::string& golden) {
+    SimdLevel selected = activeSimdLevel();
+    RenderScheduler& scheduler = RenderScheduler::instance();
+
+    std::map<std::string, std::string> expected;
+    if (!record) {
+        FILE* in = std::fopen(golden.c_str(), "r");
+        if (!in) {
+            std::fprintf(stderr, "cannot read %s, record it with --record\n", golden.c_str());
+            return false;
+        }
+        char line[256];
+        while (std::fgets(line, sizeof(line), in)) {
+            if (line[0] == '#') continue;
+            line[std::strcspn(line, "\n")] = 0;
+            char* space = std::strchr(line, ' ');
+            if (!space) continue;
+            expected[std::string(line, space)] = space + 1;
+        }
+        std::fclose(in);
+    }
+    std::vector<std::pair<std::string, std::string>> recorded;
+
+    int cases = 0;
+    int failures = 0;
+    auto fail = [&](const std::string& name, const std::string& what) {
+        std::printf("FAIL %s: %s\n", name.c_str(), what.c_str());
+        failures++;
+    };
+    auto exact = [&](const std::string& name, const char* path, const Frames& reference, const Frames& candidate) {
+        Difference difference = compare(reference, candidate, 0);
+        if (!difference.sameSize || difference.maxError > 0) {
+            fail(name, std::string(path) + " differs from the reference, max error " + std::to_string(difference.maxError));
+        }
+    };
+
+    for (const Corpus& corpus : makeCorpora()) {
+        for (const Preset& preset : PRESETS) {
+            std::string name = std::string(corpus.name) + "/" + preset.name;
+            ProcessingParams params;
+            preset.set(params);
+            cases++;
+
+            useSimdLevel(SIMD_SSE2);
+            scheduler.setSerial(true);
+            Frames reference = render(corpus, params);
+            if (reference.empty()) {
+                fail(name, "reference render failed");
+                continue;
+            }
+            std::string hash = hashString(hashFrames(reference));
+            if (record) {
+                recorded.push_back({name, hash});
+            } else {
+                auto it = expected.find(name);
+                if (it == expected.end()) {
+                    fail(name, "no golden hash");
+                } else if (it->second != hash) {
+                    fail(name, "reference hash " + hash + " differs from golden " + it->second);
+                }
+            }
+
+            // Tiles on the render threads, and the rest of the paths with them
+            scheduler.setSerial(false);
+            exact(name, "tiled render", reference, render(corpus, params));
+
+            if (corpus.animated) {
+                Frames prerendered = prerender(corpus, params);
+                bool history = params.feedback > 0.0f || params.motionMosh > 0.0f;
+                if (history && !prerendered.empty()) {
+                    fail(name, "pre-rendered through frame history");
+                } else if (!history) {
+                    exact(name, "pre-render", reference, prerendered);
+                }
+            }
+
+            // Every instruction set has to round exactly like SSE2
+            for (SimdLevel level : {SIMD_AVX2, SIMD_AVX512}) {
+                if (!useSimdLevel(level)) continue;
+                exact(name, simdLevelName(level), reference, render(corpus, params));
+            }
+            useSimdLevel(SIMD_SSE2);
+
+            ProcessingParams scanlineParams = params;
+            scanlineParams.scanlines = true;
+            exact(name, "scanline groups", reference, render(corpus, scanlineParams));
+
+            // Fixed point rows round alike on every instruction set too,
+            // noise included
+            ProcessingParams fixedParams = params;
+            fixedParams.fixedPoint = true;
+            if (FixedPointPipeline::supports(fixedParams)) {
+                Frames fixedReference = render(corpus, fixedParams);
+                for (SimdLevel level : {SIMD_AVX2, SIMD_AVX512}) {
+                    if (!useSimdLevel(level)) continue;
+                    exact(name, (std::string("fixed point ") + simdLevelName(level)).c_str(), fixedReference,
+                          render(corpus, fixedParams));
+                }
+                useSimdLevel(SIMD_SSE2);
+            }
+
+            // Noise draws different random numbers on the integer path.
+            // Error diffusion carries every rounding difference on to the
+            // next pixels, so the rows it starts from are compared instead.
+            if (FixedPointPipeline::supports(fixedParams) && params.noise <= 0.0f) {
+                Frames floatRows = reference;
+                if (params.diffusionMode != ErrorDiffusion::OFF) {
+                    ProcessingParams rowParams = params;
+                    rowParams.diffusionMode = ErrorDiffusion::OFF;
+                    rowParams.posterize = 0.0f;
+                    floatRows = render(corpus, rowParams);
+                    fixedParams.diffusionMode = ErrorDiffusion::OFF;
+                    fixedParams.posterize = 0.0f;
+                }
+                Difference fixed = compare(floatRows, render(corpus, fixedParams), FIXED_POINT_MAX_ERROR);
+                if (!fixed.sameSize || fixed.outliers > FIXED_POINT_MAX_OUTLIERS || fixed.meanError > FIXED_POINT_MAX_MEAN) {
+                    fail(name, string::f("fixed point off by up to %d, mean %.3f, %.2f%% over %d",
+                                         fixed.maxError, fixed.meanError, fixed.outliers * 100.0, FIXED_POINT_MAX_ERROR));
+                }
+            }
+        }
+    }
+    useSimdLevel(selected);
+
+    if (record) {
+        FILE* out = std::fopen(golden.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", golden.c_str());
+            return false;
+        }
+        std::fprintf(out, "# corpus/preset hash of the reference frames, compiler " __VERSION__ "\n");
+        for (const auto& entry : recorded) {
+            std::fprintf(out, "%s %s\n", entry.first.c_str(), entry.second.c_str());
+        }
+        std::fclose(out);
+        std::printf("recorded %zu cases to %s\n", recorded.size(), golden.c_str());
+    }
+
+    std::printf("%d cases, %d failures\n", cases, failures);
+    return failures == 0;
+}
+
+int main(int argc, char** argv) {
+    bool record = argc > 1 && std::strcmp(argv[1], "--record") == 0;
+    int pathArgument = record ? 2 : 1;
+    std::string golden = argc > pathArgument ? argv[pathArgument] : "render-golden.txt";
+
+    selectSimdKernels();
+    // As many threads as Rack would use at most, whatever this machine has,
+    // so parallelFor always splits
+    RenderScheduler::instance().start(RenderScheduler::MAX_THREADS);
+    std::printf("%s kernels available, %u render threads\n", simdLevelName(detectSimdLevel()), RenderScheduler::MAX_THREADS);
+
+    return RenderVerifier::run(record, golden) ? 0 : 1;
+}